@@ -0,0 +1,24 @@
+# Command-line batch tool: the mesh kernel without Qt or OpenGL, for running operations on machines without a display
+CONFIG -= qt
+CONFIG += console c++2a
+CONFIG += warn_on
+
+TARGET = meshtool
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../include
+
+include(../src/core.pri)
+
+SOURCES += $$PWD/main.cpp \
+    $$PWD/operations.cpp
+
+HEADERS += $$PWD/operations.h
+
+unix: LIBS += -pthread
+
+*-clang*|*-g++* {
+    CONFIG -= warn_on
+    QMAKE_CXXFLAGS += -Wall -Wextra -pedantic -Winit-self
+    QMAKE_CXXFLAGS += -Wno-strict-aliasing
+}
@@ -0,0 +1,27 @@
+#include "operations.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+meshtool: runs the mesh operations from the editor on files, without a window or GL context.
+Operations are applied left to right, so "-s 2 -o smooth.obj -t -o tris.obj" saves the mesh before and after triangulating.
+Exits with 0 on success and 1 on any bad argument or file error, so it can be driven from batch scripts.
+*/
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+    const std::string input = argv[1];
+
+    // check every argument before touching any file, so a typo doesn't cost a long subdivision
+    std::vector<Operation> ops;
+    if (!parseOperations(std::vector<std::string>(argv + 2, argv + argc), ops)) return 1;
+
+    HalfEdgeMesh mesh;
+    if (!readInput(input, mesh) || !applyOperations(ops, mesh)) return 1;
+    return 0;
+}
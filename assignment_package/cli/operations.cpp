@@ -0,0 +1,188 @@
+#include "operations.h"
+#include <adaptivesubdivision.h>
+#include <limitsurface.h>
+#include <meshfile.h>
+#include <objreader.h>
+#include <objwriter.h>
+#include <parallel.h>
+#include <cstdlib>
+#include <iostream>
+
+void printUsage() {
+    std::cerr << "usage: meshtool <input.obj|input.hem> [operations...]\n"
+                 "  -s, --subdivide N    apply N levels of Catmull-Clark subdivision\n"
+                 "  -L, --loop N         apply N levels of Loop subdivision (triangle meshes only)\n"
+                 "  -a, --adaptive N     apply N levels of Catmull-Clark only around extraordinary vertices (and bends, see -b)\n"
+                 "  -b, --bend DEG       make later -a also refine where neighbouring faces bend by more than DEG degrees\n"
+                 "  -c, --corners RULE   how later -s, -L and -a carry uvs and normals: smooth (default) or linear\n"
+                 "  -l, --limit          move every vertex onto the limit surface, and give each corner the limit normal\n"
+                 "  -t, --triangulate    split every face into triangles\n"
+                 "  -o, --output FILE    write the mesh as it is at this point (.hem or .obj, by extension)\n"
+                 "  -j, --threads N      number of threads to use (default: one per core)\n";
+}
+
+static bool hasExtension(const std::string& path, const std::string& ext) {
+    return path.size() >= ext.size() && path.compare(path.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+// a count for -s / -j: a plain non-negative number, nothing else
+static bool parseCount(const std::string& s, int& out) {
+    char* end = nullptr;
+    long value = std::strtol(s.c_str(), &end, 10);
+    if (s.empty() || *end != '\0' || value < 0 || value > 1 << 16) return false;
+    out = int(value);
+    return true;
+}
+
+// the rule for -c, by name
+static bool parseCorners(const std::string& s, CornerInterpolation& out) {
+    if (s == "smooth") out = CornerInterpolation::SMOOTH;
+    else if (s == "linear") out = CornerInterpolation::LINEAR;
+    else return false;
+    return true;
+}
+
+// an angle for -b: a number in [0, 180]
+static bool parseAngle(const std::string& s, float& out) {
+    char* end = nullptr;
+    float value = std::strtof(s.c_str(), &end);
+    if (s.empty() || *end != '\0' || !(value >= 0.f && value <= 180.f)) return false;
+    out = value;
+    return true;
+}
+
+bool parseOperations(const std::vector<std::string>& args, std::vector<Operation>& ops) {
+    float bend = 0.f;
+    CornerInterpolation corners = CornerInterpolation::SMOOTH;
+    for (std::size_t i = 0; i < args.size(); i++) {
+        const std::string& arg = args[i];
+        const bool hasValue = i + 1 < args.size();
+        if (arg == "-s" || arg == "--subdivide") {
+            Operation op(Operation::SUBDIVIDE);
+            if (!hasValue || !parseCount(args[++i], op.count)) {
+                std::cerr << arg << " needs a number of levels\n";
+                return false;
+            }
+            op.corners = corners;
+            ops.push_back(op);
+        } else if (arg == "-L" || arg == "--loop") {
+            Operation op(Operation::LOOP);
+            if (!hasValue || !parseCount(args[++i], op.count)) {
+                std::cerr << arg << " needs a number of levels\n";
+                return false;
+            }
+            op.corners = corners;
+            ops.push_back(op);
+        } else if (arg == "-a" || arg == "--adaptive") {
+            Operation op(Operation::ADAPTIVE);
+            if (!hasValue || !parseCount(args[++i], op.count)) {
+                std::cerr << arg << " needs a number of levels\n";
+                return false;
+            }
+            op.bend = bend;
+            op.corners = corners;
+            ops.push_back(op);
+        } else if (arg == "-b" || arg == "--bend") {
+            if (!hasValue || !parseAngle(args[++i], bend)) {
+                std::cerr << arg << " needs an angle in degrees, from 0 to 180\n";
+                return false;
+            }
+        } else if (arg == "-c" || arg == "--corners") {
+            if (!hasValue || !parseCorners(args[++i], corners)) {
+                std::cerr << arg << " needs smooth or linear\n";
+                return false;
+            }
+        } else if (arg == "-l" || arg == "--limit") {
+            ops.push_back(Operation(Operation::LIMIT));
+        } else if (arg == "-t" || arg == "--triangulate") {
+            ops.push_back(Operation(Operation::TRIANGULATE));
+        } else if (arg == "-o" || arg == "--output") {
+            if (!hasValue) {
+                std::cerr << arg << " needs a file name\n";
+                return false;
+            }
+            Operation op(Operation::OUTPUT);
+            op.path = args[++i];
+            if (!hasExtension(op.path, ".obj") && !hasExtension(op.path, ".hem")) {
+                std::cerr << "don't know how to write " << op.path << ", use .obj or .hem\n";
+                return false;
+            }
+            ops.push_back(op);
+        } else if (arg == "-j" || arg == "--threads") {
+            int threads = 0;
+            if (!hasValue || !parseCount(args[++i], threads) || threads == 0) {
+                std::cerr << arg << " needs a number of threads\n";
+                return false;
+            }
+            setThreadCount(threads);
+        } else {
+            std::cerr << "unknown argument " << arg << "\n";
+            printUsage();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool readInput(const std::string& path, HalfEdgeMesh& mesh) {
+    if (hasExtension(path, ".hem")) {
+        if (!readMeshFile(path, mesh)) {
+            std::cerr << "Unable to open mesh file " << path << "\n";
+            return false;
+        }
+    } else {
+        ObjData obj;
+        if (!readOBJ(path, obj)) {
+            std::cerr << "Unable to open file " << path << "\n";
+            return false;
+        }
+        mesh.buildMesh(obj);
+    }
+    return true;
+}
+
+bool applyOperations(const std::vector<Operation>& ops, HalfEdgeMesh& mesh) {
+    for (const Operation& op : ops) {
+        switch (op.type) {
+            case Operation::SUBDIVIDE:
+                mesh.cornerInterpolation = op.corners;
+                for (int level = 0; level < op.count; level++) mesh.catmullClark();
+                break;
+            case Operation::LOOP:
+                mesh.cornerInterpolation = op.corners;
+                for (int level = 0; level < op.count; level++) mesh.loopSubdivision();
+                break;
+            case Operation::ADAPTIVE: {
+                AdaptiveCriteria criteria;
+                criteria.maxBendDegrees = op.bend;
+                mesh.cornerInterpolation = op.corners;
+                adaptiveCatmullClark(mesh, op.count, criteria);
+                break;
+            }
+            case Operation::LIMIT: {
+                std::vector<glm::vec3> limit, normals;
+                if (!limitVertices(mesh, limit, normals)) {
+                    std::cerr << "can't find the limit surface of a mesh with boundary or sharp edges\n";
+                    return false;
+                }
+                mesh.positions.swap(limit);
+                // the uvs belong to the corners, which haven't moved, so only the normals are replaced
+                mesh.heNormal.resize(mesh.numHalfEdges());
+                for (Index he = 0; he < mesh.numHalfEdges(); he++) mesh.heNormal[he] = normals[mesh.heVertex[he]];
+                break;
+            }
+            case Operation::TRIANGULATE:
+                mesh.triangulateAllFaces();
+                break;
+            case Operation::OUTPUT: {
+                bool ok = hasExtension(op.path, ".hem") ? writeMeshFile(op.path, mesh) : writeOBJ(op.path, mesh);
+                if (!ok) {
+                    std::cerr << "Unable to write " << op.path << "\n";
+                    return false;
+                }
+                break;
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <halfedgemesh.h>
+#include <string>
+#include <vector>
+
+// One step of a meshtool run, as given on the command line (see printUsage)
+struct Operation
+{
+    enum Type {SUBDIVIDE, LOOP, ADAPTIVE, LIMIT, TRIANGULATE, OUTPUT};
+    Type type;
+    int count = 0;          // levels, for SUBDIVIDE, LOOP and ADAPTIVE
+    CornerInterpolation corners = CornerInterpolation::SMOOTH;  // for SUBDIVIDE, LOOP and ADAPTIVE
+    float bend = 0.f;       // for ADAPTIVE
+    std::string path;       // for OUTPUT
+
+    Operation(Type type) : type(type) {}
+};
+
+void printUsage();
+// Parses the arguments after the input file into ops. -j takes effect right away, since it isn't an operation.
+// Returns false, having said why on std::cerr, at the first bad argument
+bool parseOperations(const std::vector<std::string>& args, std::vector<Operation>& ops);
+// Reads a .hem file, or anything else as an OBJ. Returns false, having said why on std::cerr, if it can't
+bool readInput(const std::string& path, HalfEdgeMesh& mesh);
+// Applies ops to mesh left to right. Returns false, having said why on std::cerr, at the first one that fails
+bool applyOperations(const std::vector<Operation>& ops, HalfEdgeMesh& mesh);
@@ -3,7 +3,10 @@
 // Refer to the lambert shader files for useful comments
 
 uniform mat4 u_Model;
-uniform mat4 u_ViewProj;
+layout(std140) uniform Camera {
+    mat4 u_ViewProj;
+    vec3 u_CamPos;
+};
 
 in vec3 vs_Pos;
 in vec3 vs_Col;
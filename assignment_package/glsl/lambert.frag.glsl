@@ -10,7 +10,10 @@
 // can compute what color to apply to its pixel based on things like vertex
 // position, light position, and vertex color.
 
-uniform vec3 u_CamPos;
+layout(std140) uniform Camera {  // The same block as in lambert.vert.glsl
+    mat4 u_ViewProj;
+    vec3 u_CamPos;
+};
 
 // These are the interpolated values out of the rasterizer, so you can't know
 // their specific values without knowing the vertices that contributed to them
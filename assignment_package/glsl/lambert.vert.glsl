@@ -15,9 +15,10 @@ uniform mat4 u_ModelInvTr;  // The inverse transpose of the model matrix.
                             // This allows us to transform the object's normals properly
                             // if the object has been non-uniformly scaled.
 
-uniform mat4 u_ViewProj;    // The matrix that defines the camera's transformation.
-                            // We've written a static matrix for you to use for HW2,
-                            // but in HW3 you'll have to generate one yourself
+layout(std140) uniform Camera {  // Shared by every shader, and set once per frame (see CameraBlock
+    mat4 u_ViewProj;             // in shaderprogram.h). u_ViewProj defines the camera's transformation,
+    vec3 u_CamPos;               // u_CamPos is where the camera is.
+};
 
 in vec3 vs_Pos;             // The array of vertex positions passed to the shader
 
@@ -0,0 +1,173 @@
+#include "adaptivesubdivision.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+// What adaptive subdivision has to remember about the mesh from one level to the next
+class AdaptiveRefiner
+{
+private:
+    const AdaptiveCriteria& criteria;
+    std::vector<bool> active;           // per face: made by the last level, so it may be refined again
+    std::vector<bool> selected;         // per face: comes from a selected cage face
+    std::vector<bool> extraordinary;    // per vertex: irregular valence, or on a sharp edge
+    std::vector<Index> cageFace;        // per face: the cage face it was cut from
+
+public:
+    AdaptiveRefiner(const HalfEdgeMesh& cage, const AdaptiveCriteria& criteria);
+    // the faces the next level should refine
+    std::vector<bool> facesToRefine(const HalfEdgeMesh& m) const;
+    // m.catmullClarkSelected(refineFace), keeping track of which faces and vertices came from where
+    void refine(HalfEdgeMesh& m, const std::vector<bool>& refineFace);
+    const std::vector<Index>& cageFaces() const {return cageFace;}
+};
+
+AdaptiveRefiner::AdaptiveRefiner(const HalfEdgeMesh& cage, const AdaptiveCriteria& criteria)
+    : criteria(criteria), active(cage.numFaces(), true), selected(criteria.selectedFaces), extraordinary(cage.numVertices(), false), cageFace(cage.numFaces())
+{
+    selected.resize(cage.numFaces(), false);
+    std::iota(cageFace.begin(), cageFace.end(), 0);
+    for (Index v = 0; v < cage.numVertices(); v++) {
+        int numFaces = 0;
+        bool boundary = false, sharp = false;
+        cage.forEachIncoming(v, [&](Index he) {
+            numFaces++;
+            boundary = boundary || cage.isBoundary(he) || cage.isBoundary(cage.heNext[he]);
+            sharp = sharp || cage.sharpness(he) > 0.f;
+        });
+        if (numFaces > 0) extraordinary[v] = sharp || numFaces != (boundary ? 2 : 4);
+    }
+}
+
+// Newell's normal, which doesn't mind a polygon being a little out of plane. zero for a degenerate face
+static glm::vec3 faceNormal(const HalfEdgeMesh& m, Index f) {
+    glm::vec3 n(0.f);
+    Index cur = m.faceEdge[f];
+    do {
+        const glm::vec3& a = m.positions[m.heVertex[cur]];
+        const glm::vec3& b = m.positions[m.heVertex[m.heNext[cur]]];
+        n += glm::vec3((a.y - b.y) * (a.z + b.z), (a.z - b.z) * (a.x + b.x), (a.x - b.x) * (a.y + b.y));
+        cur = m.heNext[cur];
+    } while (cur != m.faceEdge[f]);
+    float len = glm::length(n);
+    return len > 0.f ? n / len : n;
+}
+
+std::vector<bool> AdaptiveRefiner::facesToRefine(const HalfEdgeMesh& m) const {
+    const bool checkBend = criteria.maxBendDegrees > 0.f;
+    const float minCos = std::cos(glm::radians(criteria.maxBendDegrees));
+    std::vector<glm::vec3> normals;
+    if (checkBend) {
+        normals.resize(m.numFaces());
+        for (Index f = 0; f < m.numFaces(); f++) {
+            if (active[f]) normals[f] = faceNormal(m, f);
+        }
+    }
+
+    auto isFeature = [&](Index f) {
+        if (selected[f]) return true;
+        if (criteria.extraordinary) {
+            if (m.faceDegree(f) != 4) return true;
+            Index cur = m.faceEdge[f];
+            do {
+                if (extraordinary[m.heVertex[cur]]) return true;
+                cur = m.heNext[cur];
+            } while (cur != m.faceEdge[f]);
+        }
+        if (checkBend) {
+            Index cur = m.faceEdge[f];
+            do {
+                if (m.isBoundary(cur)) {
+                    cur = m.heNext[cur];
+                    continue;
+                }
+                Index g = m.heFace[m.heSym[cur]];
+                // a neighbour left at a coarser level has no normal worked out, so it is measured here
+                glm::vec3 ng = active[g] ? normals[g] : faceNormal(m, g);
+                if (glm::dot(normals[f], ng) < minCos) return true;
+                cur = m.heNext[cur];
+            } while (cur != m.faceEdge[f]);
+        }
+        return false;
+    };
+
+    // every feature face and the faces around its vertices, as far as they can still be refined
+    std::vector<bool> refineFace(m.numFaces(), false);
+    for (Index f = 0; f < m.numFaces(); f++) {
+        if (!active[f] || !isFeature(f)) continue;
+        Index corner = m.faceEdge[f];
+        do {
+            m.forEachIncoming(m.heVertex[corner], [&](Index he) {
+                if (active[m.heFace[he]]) refineFace[m.heFace[he]] = true;
+            });
+            corner = m.heNext[corner];
+        } while (corner != m.faceEdge[f]);
+    }
+    return refineFace;
+}
+
+void AdaptiveRefiner::refine(HalfEdgeMesh& m, const std::vector<bool>& refineFace) {
+    // catmullClarkSelected adds a centroid per refined face, then the midpoints, and splits each refined face of
+    // degree n into itself and n-1 new faces, all in face order
+    std::vector<Index> refinedFaces;
+    std::vector<int> degree;
+    for (Index f = 0; f < m.numFaces(); f++) {
+        if (!refineFace[f]) continue;
+        refinedFaces.push_back(f);
+        degree.push_back(m.faceDegree(f));
+    }
+    Index numVerts = m.numVertices();
+    Index numFaces = m.numFaces();
+
+    m.catmullClarkSelected(refineFace);
+
+    // a face left behind now has midpoints on some of its sides, so it stays at this level for good
+    active = refineFace;
+    active.resize(m.numFaces(), true);
+    selected.resize(m.numFaces(), false);
+    cageFace.resize(m.numFaces());
+    Index child = numFaces;
+    for (Index i = 0; i < refinedFaces.size(); i++) {
+        for (int c = 1; c < degree[i]; c++) {
+            selected[child] = selected[refinedFaces[i]];
+            cageFace[child++] = cageFace[refinedFaces[i]];
+        }
+    }
+    // the centroid of an n-gon has valence n. midpoints of edges always have valence 4 (or 3 next to a face left behind,
+    // which isn't a feature of the surface), except on a crease that is still sharp
+    extraordinary.resize(m.numVertices(), false);
+    for (Index i = 0; i < refinedFaces.size(); i++) {
+        extraordinary[numVerts + i] = degree[i] != 4;
+    }
+    for (Index v = numVerts + refinedFaces.size(); v < m.numVertices(); v++) {
+        m.forEachIncoming(v, [&](Index he) {
+            if (m.sharpness(he) > 0.f) extraordinary[v] = true;
+        });
+    }
+}
+
+void adaptiveCatmullClark(HalfEdgeMesh& mesh, int levels, const AdaptiveCriteria& criteria) {
+    AdaptiveRefiner refiner(mesh, criteria);
+    for (int level = 0; level < levels; level++) {
+        std::vector<bool> refineFace = refiner.facesToRefine(mesh);
+        if (std::find(refineFace.begin(), refineFace.end(), true) == refineFace.end()) break;
+        refiner.refine(mesh, refineFace);
+    }
+}
+
+void buildAdaptiveSubdivisionStencils(const HalfEdgeMesh& cage, int levels, const AdaptiveCriteria& criteria,
+                                      HalfEdgeMesh& refined, StencilTable& stencils,
+                                      std::vector<Index>* cageFaces) {
+    refined = cage;
+    const Index numCage = cage.numVertices();
+    stencils.setIdentity(numCage);
+    AdaptiveRefiner refiner(cage, criteria);
+    for (int level = 0; level < levels; level++) {
+        std::vector<bool> refineFace = refiner.facesToRefine(refined);
+        if (std::find(refineFace.begin(), refineFace.end(), true) == refineFace.end()) break;
+        subdivideStencils(refined, refineFace, numCage, stencils);
+        refiner.refine(refined, refineFace);
+    }
+    stencils.buildDependents(numCage);
+    if (cageFaces) *cageFaces = refiner.cageFaces();
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <halfedgemesh.h>
+#include <stenciltable.h>
+#include <vector>
+
+/*
+Feature-adaptive Catmull-Clark. Uniform subdivision multiplies the face count by four every level, but on regular,
+flat-ish stretches of a mesh the extra faces barely move. Here each level only refines the faces that need it,
+with HalfEdgeMesh::catmullClarkSelected, so the face count grows with the size of the features instead of the mesh.
+
+A face is refined when it was refined at the level before (everything is, at the first level) and it
+    - touches an extraordinary vertex (valence other than 4, or 2 faces on a boundary) or a sharp edge, or isn't a quad,
+    - comes from one of the selected cage faces, or
+    - bends away from a neighbour by more than maxBendDegrees,
+or it shares a vertex with such a face, so every feature is smoothed with a full ring of refined faces around it.
+The faces left behind at the edge of a refined region pick up the new edge midpoints as extra corners, so the mesh stays
+crack-free between levels.
+*/
+struct AdaptiveCriteria
+{
+    bool extraordinary = true;
+    std::vector<bool> selectedFaces;    // per cage face, empty for none
+    float maxBendDegrees = 0.f;         // 0 to not look at the shape at all
+};
+
+// applies up to `levels` levels of adaptive subdivision to mesh, stopping early once no face needs refining
+void adaptiveCatmullClark(HalfEdgeMesh& mesh, int levels, const AdaptiveCriteria& criteria);
+
+// adaptiveCatmullClark on a copy of `cage` into `refined`, with stencils from cage vertices to refined vertices, as
+// buildSubdivisionStencils does for uniform subdivision. The faces to refine are picked once, from the cage as it is now,
+// so moving cage vertices afterwards keeps the same refinement.
+// If cageFaces is given, it gets the cage face each refined face was cut from.
+void buildAdaptiveSubdivisionStencils(const HalfEdgeMesh& cage, int levels, const AdaptiveCriteria& criteria,
+                                      HalfEdgeMesh& refined, StencilTable& stencils,
+                                      std::vector<Index>* cageFaces = nullptr);
@@ -0,0 +1,32 @@
+# Everything here builds without Qt or OpenGL: the half-edge kernel and the readers/writers around it.
+# Both the viewer (src.pri) and the command-line tool (cli/cli.pro) include this.
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+SOURCES += \
+    $$PWD/adaptivesubdivision.cpp \
+    $$PWD/halfedgemesh.cpp \
+    $$PWD/limitsurface.cpp \
+    $$PWD/mappedfile.cpp \
+    $$PWD/meshfile.cpp \
+    $$PWD/objreader.cpp \
+    $$PWD/objwriter.cpp \
+    $$PWD/parallel.cpp \
+    $$PWD/stenciltable.cpp \
+    $$PWD/subdivisionhierarchy.cpp
+
+HEADERS += \
+    $$PWD/adaptivesubdivision.h \
+    $$PWD/debug.h \
+    $$PWD/dirtyflags.h \
+    $$PWD/halfedgemesh.h \
+    $$PWD/limitsurface.h \
+    $$PWD/mappedfile.h \
+    $$PWD/meshcomponents.h \
+    $$PWD/meshfile.h \
+    $$PWD/objreader.h \
+    $$PWD/objwriter.h \
+    $$PWD/parallel.h \
+    $$PWD/stenciltable.h \
+    $$PWD/subdivisionhierarchy.h \
+    $$PWD/subdivisionrules.h
@@ -0,0 +1,41 @@
+#pragma once
+
+// what changed since the last frame. the mesh and selection buffers are updated as they change; the flags say a
+// repaint is due, and the viewer re-sends what it keeps itself (the camera block)
+enum DirtyFlag : unsigned {
+    DIRTY_CAMERA = 1,       // the view moved or the viewport was resized
+    DIRTY_MESH = 2,         // the mesh or its preview changed
+    DIRTY_SELECTION = 4,    // the selected vertex, face or half-edge changed
+};
+
+/*
+The repaint bookkeeping of the viewer, kept apart from Qt so it can be checked without a window.
+Changes pile up between frames: only the first one after a frame asks for a repaint, and the frame then takes them all.
+Everything counts as changed before the first frame.
+*/
+class DirtyFlags
+{
+private:
+    unsigned flags = DIRTY_CAMERA | DIRTY_MESH | DIRTY_SELECTION;
+    bool repaintRequested = false;
+    unsigned long long frames = 0;
+
+public:
+    // adds `changed`. true if that needs a repaint asked for, false if one already is
+    bool mark(unsigned changed) {
+        flags |= changed;
+        if (repaintRequested) return false;
+        repaintRequested = true;
+        return true;
+    }
+    // at the start of a frame: everything marked since the last one, which is then cleared
+    unsigned beginFrame() {
+        unsigned changed = flags;
+        flags = 0;
+        repaintRequested = false;
+        ++frames;
+        return changed;
+    }
+    // the number of frames painted so far, to check that nothing repaints while nothing changes
+    unsigned long long frameCount() const {return frames;}
+};
@@ -1,8 +1,9 @@
 #include "drawable.h"
+#include <cstddef>
 
 Drawable::Drawable(OpenGLContext *context)
     : glContext(context),
-      bufferHandles(),
+      bufferHandles(), vao(0),
       indexBufferLength(-1)
 {}
 
@@ -15,6 +16,9 @@ void Drawable::destroyGPUData() {
     for(auto &kvp : bufferHandles) {
         glContext->glDeleteBuffers(1, &kvp.second);
 }
+    bufferHandles.clear();
+    if (vao != 0) glContext->glDeleteVertexArrays(1, &vao);
+    vao = 0;
     indexBufferLength = 0;
 }
 
@@ -23,8 +27,21 @@ GLenum Drawable::drawMode() {
 }
 
 void Drawable::generateBuffer(BufferType t) {
+    if (vao == 0) glContext->glGenVertexArrays(1, &vao);
+    glContext->glBindVertexArray(vao);
     bufferHandles[t] = 0; // placeholder, just inserts a kvp into the map
     glContext->glGenBuffers(1, &(bufferHandles.at(t)));
+    if (t != BufferType::VERTEX) return;
+
+    // the VAO keeps this, so a draw doesn't have to point the attributes at the buffer again
+    glContext->glBindBuffer(GL_ARRAY_BUFFER, bufferHandles.at(t));
+    auto attrib = [this](VertexAttrib a, std::size_t offset) {
+        glContext->glEnableVertexAttribArray(a);
+        glContext->glVertexAttribPointer(a, 3, GL_FLOAT, false, sizeof(GLVertex), (void*)offset);
+    };
+    attrib(ATTRIB_POS, offsetof(GLVertex, pos));
+    attrib(ATTRIB_NOR, offsetof(GLVertex, nor));
+    attrib(ATTRIB_COL, offsetof(GLVertex, col));
 }
 
 void Drawable::bindBuffer(BufferType t) {
@@ -32,10 +49,16 @@ void Drawable::bindBuffer(BufferType t) {
         glContext->glBindBuffer(GL_ARRAY_BUFFER, bufferHandles.at(t));
     }
     else {
+        // which index buffer is bound is part of the VAO
+        glContext->glBindVertexArray(vao);
         glContext->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufferHandles.at(t));
     }
 }
 
+void Drawable::bindVertexArray() {
+    glContext->glBindVertexArray(vao);
+}
+
 bool Drawable::hasBuffer(BufferType t) const {
     return bufferHandles.contains(t);
 }
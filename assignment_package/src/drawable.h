@@ -4,16 +4,33 @@
 #include <la.h>
 
 enum BufferType {
-    POSITION, NORMAL, COLOR,
+    VERTEX,  // GLVertex records, every attribute of a vertex side by side
     INDEX
 };
 
+// the attribute locations ShaderProgram binds the vertex shaders' inputs to, so one VAO works with every shader
+enum VertexAttrib : GLuint {
+    ATTRIB_POS = 0,  // vs_Pos
+    ATTRIB_NOR = 1,  // vs_Nor
+    ATTRIB_COL = 2   // vs_Col
+};
+
+// one vertex of a Drawable's vertex buffer
+struct GLVertex {
+    glm::vec3 pos;
+    glm::vec3 nor;
+    glm::vec3 col;
+};
+
 class Drawable {
 protected:
     // See MyGL's `glContext` member for more info
     OpenGLContext *glContext;
 
     std::unordered_map<BufferType, GLuint> bufferHandles;
+    // records the buffers above and where each attribute sits in the vertex buffer, once, when they are generated.
+    // 0 until then
+    GLuint vao;
 
     // We will store the number of indices that we send to our
     // index buffer. For example, if the index buffer was
@@ -39,9 +56,12 @@ public:
     // You can write subclasses that return GL_LINES or GL_POINTS.
     virtual GLenum drawMode();
 
+    // also creates the VAO if there is none yet, and for VERTEX sets up the attribute layout in it
     void generateBuffer(BufferType t);
     void bindBuffer(BufferType t);
     bool hasBuffer(BufferType t) const;
+    // makes the buffers current for drawing
+    void bindVertexArray();
 
     template<class T>
     void bufferData(BufferType t, const std::vector<T> &data) {
@@ -49,6 +69,13 @@ public:
         glContext->glBufferData(target, data.size() * sizeof(T), data.data(), GL_STATIC_DRAW);
     }
 
+    // overwrites part of an existing buffer, starting `offset` elements in
+    template<class T>
+    void bufferSubData(BufferType t, std::size_t offset, const std::vector<T> &data) {
+        GLenum target = (t == INDEX ? GL_ELEMENT_ARRAY_BUFFER : GL_ARRAY_BUFFER);
+        glContext->glBufferSubData(target, offset * sizeof(T), data.size() * sizeof(T), data.data());
+    }
+
 
     int getIndexBufferLength() const;
 };
@@ -0,0 +1,1177 @@
+#include "halfedgemesh.h"
+#include "debug.h"
+#include "parallel.h"
+#include "subdivisionrules.h"
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+
+void HalfEdgeMesh::clear() {
+    positions.clear();
+    vertexEdge.clear();
+    faceColors.clear();
+    faceEdge.clear();
+    heNext.clear();
+    heSym.clear();
+    heVertex.clear();
+    heFace.clear();
+    heUV.clear();
+    heNormal.clear();
+    heSharpness.clear();
+}
+
+Index HalfEdgeMesh::addVertex(const glm::vec3& pos) {
+    positions.push_back(pos);
+    vertexEdge.push_back(NO_INDEX);
+    return positions.size() - 1;
+}
+
+Index HalfEdgeMesh::addFace(const glm::vec3& color) {
+    faceColors.push_back(color);
+    faceEdge.push_back(NO_INDEX);
+    return faceEdge.size() - 1;
+}
+
+Index HalfEdgeMesh::addHalfEdge() {
+    heNext.push_back(NO_INDEX);
+    heSym.push_back(NO_INDEX);
+    heVertex.push_back(NO_INDEX);
+    heFace.push_back(NO_INDEX);
+    if (hasUVs()) heUV.push_back(glm::vec2(0.f));
+    if (hasNormals()) heNormal.push_back(glm::vec3(0.f));
+    if (hasSharpness()) heSharpness.push_back(0.f);
+    return heNext.size() - 1;
+}
+
+void HalfEdgeMesh::setSharpness(Index he, float s) {
+    if (!hasSharpness()) {
+        if (s == 0.f) return;
+        heSharpness.assign(numHalfEdges(), 0.f);
+    }
+    heSharpness[he] = s;
+    if (!isBoundary(he)) heSharpness[heSym[he]] = s;
+}
+
+bool HalfEdgeMesh::hasCreases() const {
+    return std::any_of(heSharpness.begin(), heSharpness.end(), [](float s) {return s > 0.f;});
+}
+
+void HalfEdgeMesh::sharpenHalves(Index he1, Index he1b, float parent) {
+    float s = childSharpness(parent);
+    heSharpness[he1] = s;
+    heSharpness[he1b] = s;
+    if (!isBoundary(he1)) {
+        heSharpness[heSym[he1]] = s;
+        heSharpness[heSym[he1b]] = s;
+    }
+}
+
+int HalfEdgeMesh::faceDegree(Index f) const {
+    int numSides = 0;
+    Index cur = faceEdge[f];
+    do {cur = heNext[cur]; numSides++;} while (cur != faceEdge[f]);
+    return numSides;
+}
+
+void HalfEdgeMesh::updateVertexNormals(Index v) {
+    if (!hasNormals()) return;
+    // the sum of the cross products around a face is twice its area along its normal, for any polygon (Newell)
+    glm::vec3 n(0.f);
+    forEachIncoming(v, [&](Index he) {
+        Index cur = he;
+        do {
+            n += glm::cross(positions[heVertex[cur]], positions[heVertex[heNext[cur]]]);
+            cur = heNext[cur];
+        } while (cur != he);
+    });
+    float len = glm::length(n);
+    if (len > 0.f) n /= len;
+    forEachIncoming(v, [&](Index he) {heNormal[he] = n;});
+}
+
+Index HalfEdgeMesh::prevEdge(Index he) const {
+    Index cur = he;
+    while (heNext[cur] != he) cur = heNext[cur];
+    return cur;
+}
+
+void HalfEdgeMesh::splitEdge(Index he1) {
+    // dont delete anything. just add
+    // on a boundary edge there is no he2, so only he1 is split
+    Index v1 = heVertex[he1];
+    Index he2 = heSym[he1];
+    Index v2 = sourceVertex(he1);
+
+    Index v3 = addVertex(0.5f*(positions[v1] + positions[v2]));
+    Index he1b = addHalfEdge();
+    Index he2b = he2 == NO_INDEX ? NO_INDEX : addHalfEdge();
+
+    heVertex[he1b] = v1;  heFace[he1b] = heFace[he1];
+    heSym[he1b] = he2;   heNext[he1b] = heNext[he1];
+    heSym[he1] = he2b;   heNext[he1] = he1b;  heVertex[he1] = v3;
+    vertexEdge[v1] = he1b;
+    vertexEdge[v3] = he1;
+    if (he2 != NO_INDEX) {
+        heVertex[he2b] = v2;  heFace[he2b] = heFace[he2];
+        heSym[he2b] = he1;   heNext[he2b] = heNext[he2];
+        heSym[he2] = he1b;   heNext[he2] = he2b;  heVertex[he2] = v3;
+        vertexEdge[v2] = he2b;
+        vertexEdge[v3] = he2;
+    }
+
+    // he1b and he2b take over the corners he1 and he2 used to end at. the new corners at v3 are halfway
+    // between the two ends of each side, and the side's other end is the corner of the half-edge before it
+    if (hasUVs()) {
+        heUV[he1b] = heUV[he1];
+        heUV[he1] = 0.5f*(heUV[he1b] + heUV[prevEdge(he1)]);
+        if (he2 != NO_INDEX) {
+            heUV[he2b] = heUV[he2];
+            heUV[he2] = 0.5f*(heUV[he2b] + heUV[prevEdge(he2)]);
+        }
+    }
+    if (hasNormals()) {
+        heNormal[he1b] = heNormal[he1];
+        heNormal[he1] = 0.5f*(heNormal[he1b] + heNormal[prevEdge(he1)]);
+        if (he2 != NO_INDEX) {
+            heNormal[he2b] = heNormal[he2];
+            heNormal[he2] = 0.5f*(heNormal[he2b] + heNormal[prevEdge(he2)]);
+        }
+    }
+    // the two halves are still the same edge, just as sharp
+    if (hasSharpness()) {
+        heSharpness[he1b] = heSharpness[he1];
+        if (he2 != NO_INDEX) heSharpness[he2b] = heSharpness[he2];
+    }
+}
+
+void HalfEdgeMesh::triangulateFace(Index f) {
+    cutIntoTriangles(f);
+    LOG("base case: triangle face");
+}
+
+void HalfEdgeMesh::triangulateAllFaces() {
+    // the faces cut off are triangles already, so only the original ones need visiting
+    Index numFacesBefore = numFaces();
+    for (Index f = 0; f < numFacesBefore; f++) {
+        cutIntoTriangles(f);
+    }
+}
+
+void HalfEdgeMesh::cutIntoTriangles(Index f) {
+    // dont delete anything. just add
+    // each pass cuts one triangle off the front of f, so f ends up with one less side until it is a triangle itself
+    while (faceDegree(f) > 3) {
+        Index he0 = heNext[faceEdge[f]];
+        Index heA = addHalfEdge();
+        Index heB = addHalfEdge();
+
+        heVertex[heA] = heVertex[he0];
+        heVertex[heB] = heVertex[heNext[heNext[he0]]];
+        heSym[heA] = heB;  heSym[heB] = heA;
+        // the cut ends at corners f already has, so it reuses their attributes
+        if (hasUVs()) {
+            heUV[heA] = heUV[he0];
+            heUV[heB] = heUV[heNext[heNext[he0]]];
+        }
+        if (hasNormals()) {
+            heNormal[heA] = heNormal[he0];
+            heNormal[heB] = heNormal[heNext[heNext[he0]]];
+        }
+
+        Index face2 = addFace(faceColors[f]);
+        faceEdge[face2] = heA;
+
+        heFace[heA] = face2;
+        heFace[heNext[he0]] = face2;
+        heFace[heNext[heNext[he0]]] = face2;
+        heFace[heB] = f;
+
+        heNext[heB] = heNext[heNext[heNext[he0]]];
+        heNext[heNext[heNext[he0]]] = heA;
+        heNext[heA] = heNext[he0];
+        heNext[he0] = heB;
+    }
+}
+
+/*
+Corner attributes through one level of subdivision. A corner is where a half-edge points to, so after a level there are
+three kinds of new corner in each old face: at an old vertex, at the midpoint of one of the face's edges, and (for
+Catmull-Clark) at its centroid. CornerPoints holds all three, worked out from the old mesh before anything changes:
+    atVertex[he]    he's corner at the old vertex it points to
+    atEdge[he]      he's corner at the midpoint of its edge
+    atFace[f]       face f's corner at its centroid, the average of its corners
+and the level just copies them into place as it builds the new half-edges.
+With CornerInterpolation::LINEAR every face is on its own: corners keep their value and a midpoint is halfway between the
+two corners of its side. With SMOOTH, an edge whose two sides agree at both ends takes the same rule as the positions
+(subdivisionrules.h, with the attribute in place of the positions), and so does a vertex with no seam or boundary edge
+around it. Seams and boundaries stay linear, so each island is pinned along its border. Every value shared by two sides
+is worked out once, so the sides still agree bit for bit and the next level sees the same seams.
+*/
+template<class T>
+struct CornerPoints
+{
+    std::vector<T> atVertex;
+    std::vector<T> atEdge;
+    std::vector<T> atFace;
+};
+
+template<class T>
+static void computeCornerPoints(const HalfEdgeMesh& m, const std::vector<T>& corners, bool loop, CornerPoints<T>& out) {
+    const Index V = m.numVertices();
+    const Index F = m.numFaces();
+    const Index H = m.numHalfEdges();
+    const bool smooth = m.cornerInterpolation == CornerInterpolation::SMOOTH;
+
+    // prev[he] is the half-edge before he, so corners[prev[he]] is the corner he starts from
+    std::vector<Index> prev(H);
+    parallelFor(F, [&](std::size_t begin, std::size_t end) {
+        for (Index f = begin; f < end; f++) {
+            Index cur = m.faceEdge[f];
+            do {prev[m.heNext[cur]] = cur; cur = m.heNext[cur];} while (cur != m.faceEdge[f]);
+        }
+    });
+    // both sides of he's edge have the same corners at both ends
+    auto continuous = [&](Index he) {
+        Index sym = m.heSym[he];
+        return sym != NO_INDEX && corners[he] == corners[prev[sym]] && corners[prev[he]] == corners[sym];
+    };
+
+    if (!loop) {
+        out.atFace.resize(F);
+        parallelFor(F, [&](std::size_t begin, std::size_t end) {
+            for (Index f = begin; f < end; f++) {
+                T sum(0.f);
+                int numSides = 0;
+                Index cur = m.faceEdge[f];
+                do {sum += corners[cur]; numSides++; cur = m.heNext[cur];} while (cur != m.faceEdge[f]);
+                out.atFace[f] = sum / float(numSides);
+            }
+        });
+    }
+
+    out.atEdge.resize(H);
+    parallelFor(H, [&](std::size_t begin, std::size_t end) {
+        for (Index he = begin; he < end; he++) {
+            if (!smooth || !continuous(he)) {
+                out.atEdge[he] = 0.5f*(corners[he] + corners[prev[he]]);
+                continue;
+            }
+            Index sym = m.heSym[he];
+            if (sym < he) continue;  // the lower half does both
+            // the rules name old vertices. the ones they use here are the ends of the edge, and for Loop the corners
+            // opposite it, all read off the faces on either side
+            T sum(0.f);
+            auto vertex = [&](Index u, float w) {
+                if (u == m.heVertex[he]) sum += w*corners[he];
+                else if (u == m.heVertex[sym]) sum += w*corners[sym];
+                else if (u == m.heVertex[m.heNext[he]]) sum += w*corners[m.heNext[he]];
+                else sum += w*corners[m.heNext[sym]];
+            };
+            if (loop) loopEdgePoint(m, he, vertex);
+            else catmullClarkEdgePoint(m, he, vertex, [&](Index f, float w) {sum += w*out.atFace[f];});
+            out.atEdge[he] = sum;
+            out.atEdge[sym] = sum;
+        }
+    });
+
+    // a corner that isn't smoothed keeps its value
+    out.atVertex = corners;
+    if (!smooth) return;
+    parallelFor(V, [&](std::size_t begin, std::size_t end) {
+        // each neighbour of the vertex, with its corner on the edge between them
+        std::vector<std::pair<Index, T>> ring;
+        for (Index v = begin; v < end; v++) {
+            if (m.vertexEdge[v] == NO_INDEX) continue;
+            ring.clear();
+            bool interior = true;
+            m.forEachIncoming(v, [&](Index he) {
+                interior = interior && continuous(he) && !m.isBoundary(m.heNext[he]);
+                ring.push_back({m.sourceVertex(he), corners[prev[he]]});
+            });
+            if (!interior) continue;
+
+            const T center = corners[m.vertexEdge[v]];
+            T sum(0.f);
+            auto vertex = [&](Index u, float w) {
+                if (u == v) {
+                    sum += w*center;
+                    return;
+                }
+                for (const auto& [neighbour, corner] : ring) {
+                    if (neighbour == u) {
+                        sum += w*corner;
+                        return;
+                    }
+                }
+            };
+            if (loop) loopVertexPoint(m, v, vertex);
+            else catmullClarkVertexPoint(m, v, vertex, [&](Index f, float w) {sum += w*out.atFace[f];});
+            m.forEachIncoming(v, [&](Index he) {out.atVertex[he] = sum;});
+        }
+    });
+}
+
+// after he's edge is split, he ends at the midpoint and heB, the new half-edge after it, at the old vertex
+template<class T>
+static void setSplitCorners(std::vector<T>& corners, const CornerPoints<T>& p, Index he, Index heB) {
+    corners[he] = p.atEdge[he];
+    corners[heB] = p.atVertex[he];
+}
+
+struct HalfEdgeMesh::LevelCorners
+{
+    CornerPoints<glm::vec2> uv;
+    CornerPoints<glm::vec3> normal;
+
+    LevelCorners(const HalfEdgeMesh& m, bool loop) {
+        if (m.hasUVs()) computeCornerPoints(m, m.heUV, loop, uv);
+        if (m.hasNormals()) computeCornerPoints(m, m.heNormal, loop, normal);
+    }
+
+    // calls f(corners, points) for each attribute m has
+    template<class F>
+    void forEach(HalfEdgeMesh& m, F&& f) const {
+        if (m.hasUVs()) f(m.heUV, uv);
+        if (m.hasNormals()) f(m.heNormal, normal);
+    }
+};
+
+void HalfEdgeMesh::addSmoothedMidpoint(Index he1, const glm::vec3& pos, const LevelCorners& corners) {
+    // dont delete anything. just add
+    float s = sharpness(he1);
+    Index he2 = heSym[he1];
+    splitEdge(he1);
+    positions.back() = pos;
+    // the split made he1 (and he2) end at the midpoint and put the other half right after it
+    if (hasSharpness()) sharpenHalves(he1, heNext[he1], s);
+    corners.forEach(*this, [&](auto& c, const auto& p) {
+        setSplitCorners(c, p, he1, heNext[he1]);
+        if (he2 != NO_INDEX) setSplitCorners(c, p, he2, heNext[he2]);
+    });
+}
+
+// the Catmull-Clark rules of subdivisionrules.h added up into positions. centroidPos(f) is where face f's centroid is
+template<class CentroidPos>
+static glm::vec3 edgePointPosition(const HalfEdgeMesh& m, Index he, CentroidPos&& centroidPos) {
+    glm::vec3 p(0.f);
+    catmullClarkEdgePoint(m, he, [&](Index u, float w) {p += w*m.positions[u];},
+                                 [&](Index f, float w) {p += w*centroidPos(f);});
+    return p;
+}
+
+template<class CentroidPos>
+static glm::vec3 vertexPointPosition(const HalfEdgeMesh& m, Index v, CentroidPos&& centroidPos) {
+    glm::vec3 p(0.f);
+    catmullClarkVertexPoint(m, v, [&](Index u, float w) {p += w*m.positions[u];},
+                                  [&](Index f, float w) {p += w*centroidPos(f);});
+    return p;
+}
+
+void HalfEdgeMesh::computeAndAddCentroids(std::vector<Index>& faceCentroid,
+                                          Index numFaces) {
+    /*
+    In this function, we pass over every face, calculate the average of the vertices in that face,
+    and add the resulting centroid to the graph.
+    */
+    for (Index f = 0; f < numFaces; f++) {
+        glm::vec3 avg_pos = {0,0,0};
+        int numSides = 0;
+        Index cur = faceEdge[f];
+        do {
+            avg_pos += positions[heVertex[cur]];
+            numSides++;
+            cur = heNext[cur];
+        } while (cur != faceEdge[f]);
+        avg_pos /= numSides;
+
+        faceCentroid[f] = addVertex(avg_pos);
+    }
+}
+
+void HalfEdgeMesh::addAllSmoothedMidpoints(const std::vector<Index>& faceCentroid,
+                                           const std::vector<Index>& edgeHalf, const LevelCorners& corners) {
+    /*
+    In this function, we pass over every edge once, through the first half-edge of each (see edgeHalfEdges).
+    We then split every edge, set the indices, and add the new vertex and edges to the graph structure.
+    Splitting an edge doesn't change the ends or faces of any other, so each edge point can still be worked out
+    from the mesh as it was right before its own split.
+    */
+    auto centroidPos = [&](Index f) {return positions[faceCentroid[f]];};
+    for (Index he : edgeHalf) {
+        addSmoothedMidpoint(he, edgePointPosition(*this, he, centroidPos), corners);
+    }
+}
+
+void HalfEdgeMesh::smoothAllVertices(const std::vector<Index>& faceCentroid,
+                                     Index numVerts, std::vector<glm::vec3>& smoothed) {
+    /*
+    In this function, we traverse through the vertices and compute the correct smoothed position.
+    The rules read the old one-ring of each vertex, so this runs before the edges are split, and the positions
+    only go in once the midpoints have been worked out from the old ones.
+    */
+    auto centroidPos = [&](Index f) {return positions[faceCentroid[f]];};
+    smoothed.resize(numVerts);
+    for (Index vertex = 0; vertex < numVerts; vertex++) {
+        smoothed[vertex] = vertexPointPosition(*this, vertex, centroidPos);
+    }
+}
+
+void HalfEdgeMesh::quadrangulateAllFaces(const std::vector<Index>& faceCentroid,
+                                         Index numFaces, const LevelCorners& corners) {
+    /*
+    In this function, we traverse through the faces and quadrangulate.
+    We can collect all of the edges and
+    */
+    std::vector<Index> edges;
+    std::vector<Index> newFaces;
+    std::vector<Index> newEdges;
+    for (Index origFace = 0; origFace < numFaces; origFace++) {
+
+        Index centroid = faceCentroid[origFace];
+        if (centroid == NO_INDEX) continue;  // a face catmullClarkSelected leaves as it is
+
+        // collect all of the original edges in the face
+        edges.clear();
+        Index c = faceEdge[origFace];
+        do {
+            edges.push_back(c);
+            c = heNext[c];
+        }
+        while(c != faceEdge[origFace]);
+        int n = edges.size();
+
+        // create the n-1 new faces and store them in a vector.
+        newFaces = {origFace};
+        for (int i = 1; i < n/2; i++) {
+            newFaces.push_back(addFace(faceColors[origFace]));
+        }
+
+        newEdges.clear();
+
+        /*
+        This is the main logic, where we can loop through the (now) outer edges of the face,
+        and create and assign the new inner edges by just indexing into the vectors we collected before.
+        */
+        for (int i = 0; i < n; i = i+2) {
+            Index a = addHalfEdge();
+            Index b = addHalfEdge();
+
+            newEdges.push_back(a);
+            newEdges.push_back(b);
+
+            heVertex[a] = centroid;
+            heVertex[b] = heVertex[edges[((i-2)%n+n)%n]];
+            vertexEdge[centroid] = a;
+            // b ends at the same midpoint as the outer half-edge two back, in the same old face
+            corners.forEach(*this, [&](auto& c, const auto& p) {
+                c[a] = p.atFace[origFace];
+                c[b] = p.atEdge[edges[((i-2)%n+n)%n]];
+            });
+
+            Index cur = edges[i]; Index prev = edges[((i-1)%n+n)%n];
+            heNext[a] = b;
+            heNext[b] = prev;
+            heNext[prev] = cur;
+            heNext[cur] = a;
+
+            Index newFace = newFaces[i/2];
+            heFace[a] = newFace;
+            heFace[b] = newFace;
+            heFace[cur] = newFace;
+            heFace[prev] = newFace;
+            faceEdge[newFace] = b;
+
+            // we can skip the first two edges, as they'll be assigned in the last loop.
+            // each subface contains two outer edges and two new inner edges: prev->cur->a->b->prev.
+            if (i>=2) {
+                Index lastA = newEdges[i+1-3];
+                heSym[b] = lastA;
+                heSym[lastA] = b;
+
+                if (i == n-2) {
+                    Index firstB = newEdges[1];
+                    Index lastA = newEdges[n-2];
+                    heSym[firstB] = lastA;
+                    heSym[lastA] = firstB;
+                }
+            }
+        }
+    }
+}
+
+std::vector<Index> HalfEdgeMesh::edgeHalfEdges() const {
+    // of the two halves of an edge, the one with the lower index stands for it. a boundary half-edge has no other half
+    std::vector<Index> edgeHalf;
+    edgeHalf.reserve(numHalfEdges() / 2);
+    for (Index he = 0; he < numHalfEdges(); he++) {
+        if (he < heSym[he]) edgeHalf.push_back(he);
+    }
+    return edgeHalf;
+}
+
+void HalfEdgeMesh::catmullClark() {
+    /*
+    This function calls four helper functions that each independently perform a step of the Catmull-Clark algorithm.
+    It edits the original mesh graph. In each helper is a more detailed comment to explain the implemented logic.
+    Everything the helpers add is appended, so the original elements are exactly the indices below these counts.
+    With more than one thread, the same four steps run in catmullClarkParallel instead, which gives the same mesh.
+    */
+    Index numVerts = numVertices();
+    Index numFacesBefore = numFaces();
+
+    if (threadCount() > 1) {
+        catmullClarkParallel();
+    } else {
+        // the new uvs and normals, like the positions, come from the mesh before it changes
+        LevelCorners corners(*this, false);
+
+        // for each face, compute centroids (vertices) and store them in a side array indexed by face to easily query later
+        std::vector<Index> faceCentroid(numFacesBefore);
+
+        computeAndAddCentroids(faceCentroid, numFacesBefore);
+
+        std::vector<glm::vec3> smoothed;
+        smoothAllVertices(faceCentroid, numVerts, smoothed);
+
+        addAllSmoothedMidpoints(faceCentroid, edgeHalfEdges(), corners);
+
+        std::copy(smoothed.begin(), smoothed.end(), positions.begin());
+
+        quadrangulateAllFaces(faceCentroid, numFacesBefore, corners);
+    }
+    // once every crease has worn off, the mesh is smooth again
+    if (!hasCreases()) heSharpness.clear();
+}
+
+void HalfEdgeMesh::catmullClarkSelected(const std::vector<bool>& refineFace) {
+    /*
+    One level of Catmull-Clark on just the faces with refineFace set, for adaptive subdivision.
+    A refined face is split into quads exactly as in catmullClark, which means splitting all of its edges. When the face on
+    the other side of such an edge stays, the midpoint becomes an extra corner of that face too, so the two sides still
+    share every vertex and there are no T-junctions, just a few faces with more sides than before.
+    Every vertex of a refined face is smoothed with the usual rule. Where the rule needs the centroid of a face that isn't
+    refined, or the midpoint of an edge that isn't split, it uses where they would have gone without adding them.
+    Vertices away from the refined faces keep their positions.
+    New vertices are appended in the same order as in catmullClark: the centroids of the refined faces in face order,
+    then the midpoints of the split edges in edgeHalfEdges order.
+    */
+    Index numVerts = numVertices();
+    Index numFacesBefore = numFaces();
+    const Index numHalfEdgesBefore = numHalfEdges();
+
+    // where every face's centroid would go, refined or not
+    std::vector<glm::vec3> centroidPos(numFacesBefore);
+    for (Index f = 0; f < numFacesBefore; f++) {
+        glm::vec3 sum(0.f);
+        int numSides = 0;
+        Index cur = faceEdge[f];
+        do {sum += positions[heVertex[cur]]; numSides++; cur = heNext[cur];} while (cur != faceEdge[f]);
+        centroidPos[f] = sum / (float)numSides;
+    }
+    auto centroidOf = [&](Index f) {return centroidPos[f];};
+
+    // smoothed positions of the vertices on refined faces, worked out before the topology changes under them
+    std::vector<bool> smooth(numVerts, false);
+    for (Index f = 0; f < numFacesBefore; f++) {
+        if (!refineFace[f]) continue;
+        Index cur = faceEdge[f];
+        do {smooth[heVertex[cur]] = true; cur = heNext[cur];} while (cur != faceEdge[f]);
+    }
+    std::vector<glm::vec3> smoothed(numVerts);
+    for (Index v = 0; v < numVerts; v++) {
+        if (smooth[v]) smoothed[v] = vertexPointPosition(*this, v, centroidOf);
+    }
+
+    // corners at vertices that stay put keep their values too. the rest move before any edge is split, and the split
+    // edges below then set both of their halves
+    LevelCorners corners(*this, false);
+    corners.forEach(*this, [&](auto& c, const auto& p) {
+        for (Index he = 0; he < numHalfEdgesBefore; he++) {
+            if (smooth[heVertex[he]]) c[he] = p.atVertex[he];
+        }
+    });
+
+    std::vector<Index> faceCentroid(numFacesBefore, NO_INDEX);
+    for (Index f = 0; f < numFacesBefore; f++) {
+        if (refineFace[f]) faceCentroid[f] = addVertex(centroidPos[f]);
+    }
+    for (Index he : edgeHalfEdges()) {
+        if (!refineFace[heFace[he]] && (isBoundary(he) || !refineFace[heFace[heSym[he]]])) continue;
+        addSmoothedMidpoint(he, edgePointPosition(*this, he, centroidOf), corners);
+    }
+    for (Index v = 0; v < numVerts; v++) {
+        if (smooth[v]) positions[v] = smoothed[v];
+    }
+    quadrangulateAllFaces(faceCentroid, numFacesBefore, corners);
+    if (!hasCreases()) heSharpness.clear();
+}
+
+void HalfEdgeMesh::catmullClarkParallel() {
+    /*
+    The serial helpers only ever append, in a fixed order, so where every new element ends up can be worked out
+    before anything is built:
+        vertices    centroid of face f at V+f, midpoint of edge k at V+F+k
+        half-edges  edge k's new halves from newHalfStart[k] (two, or one on a boundary), then each face's 2*degree
+                    inner half-edges in face order
+        faces       each face's degree-1 new faces in face order, from F
+    where edge k is the k-th entry of edgeHalfEdges, because that is the order the serial loop splits in. With every
+    element's slot fixed, each phase writes only its own slots and runs across all threads.
+    The positions come from the same rules in the same order as the serial helpers, so they come out bit for bit the same.
+    */
+    const Index V = numVertices();
+    const Index H = numHalfEdges();
+    const Index F = numFaces();
+
+    const std::vector<Index> edgeHalf = edgeHalfEdges();
+    const Index E = edgeHalf.size();
+
+    // where each edge's new halves, and each face's new faces and inner half-edges, start
+    std::vector<Index> newHalfStart(E + 1);
+    std::vector<Index> faceSides(F);
+    std::vector<Index> newFaceStart(F + 1), newEdgeStart(F + 1);
+
+    // the new uvs and normals, which only read the old corners
+    LevelCorners corners(*this, false);
+
+    // everything is sized once up front. the counts are V+F+E vertices, 4H half-edges and H/2 faces for a closed mesh
+    positions.resize(V + F + E);
+    vertexEdge.resize(V + F + E, NO_INDEX);
+
+    // step 1: centroids, same as computeAndAddCentroids
+    parallelFor(F, [&](std::size_t begin, std::size_t end) {
+        for (Index f = begin; f < end; f++) {
+            glm::vec3 avg_pos = {0,0,0};
+            int numSides = 0;
+            Index cur = faceEdge[f];
+            do {
+                avg_pos += positions[heVertex[cur]];
+                numSides++;
+                cur = heNext[cur];
+            } while (cur != faceEdge[f]);
+            avg_pos /= numSides;
+
+            positions[V + f] = avg_pos;
+            faceSides[f] = numSides;
+        }
+    });
+
+    newHalfStart[0] = H;
+    for (Index k = 0; k < E; k++) {
+        newHalfStart[k + 1] = newHalfStart[k] + (isBoundary(edgeHalf[k]) ? 1 : 2);
+    }
+    newFaceStart[0] = F;
+    newEdgeStart[0] = newHalfStart[E];
+    for (Index f = 0; f < F; f++) {
+        newFaceStart[f + 1] = newFaceStart[f] + faceSides[f] - 1;
+        newEdgeStart[f + 1] = newEdgeStart[f] + 2*faceSides[f];
+    }
+
+    // step 2: the new positions of the midpoints and old vertices, same as addAllSmoothedMidpoints and smoothAllVertices.
+    // both read the mesh before any edge is split, and the old vertices only move once every midpoint is done
+    auto centroidPos = [&](Index f) {return positions[V + f];};
+    parallelFor(E, [&](std::size_t begin, std::size_t end) {
+        for (Index k = begin; k < end; k++) {
+            positions[V + F + k] = edgePointPosition(*this, edgeHalf[k], centroidPos);
+        }
+    });
+    std::vector<glm::vec3> smoothed(V);
+    parallelFor(V, [&](std::size_t begin, std::size_t end) {
+        for (Index vertex = begin; vertex < end; vertex++) {
+            smoothed[vertex] = vertexPointPosition(*this, vertex, centroidPos);
+        }
+    });
+
+    heNext.resize(newEdgeStart[F]);
+    heSym.resize(newEdgeStart[F]);
+    heVertex.resize(newEdgeStart[F]);
+    heFace.resize(newEdgeStart[F]);
+    if (hasSharpness()) heSharpness.resize(newEdgeStart[F], 0.f);
+    corners.forEach(*this, [&](auto& c, const auto&) {c.resize(newEdgeStart[F]);});
+    faceColors.resize(newFaceStart[F]);
+    faceEdge.resize(newFaceStart[F]);
+
+    // step 3: split every edge at its midpoint, same as addSmoothedMidpoint
+    parallelFor(E, [&](std::size_t begin, std::size_t end) {
+        // the serial loop leaves each old vertex pointing at the last new half-edge split towards it.
+        // those are numbered in split order, so the largest one wins whichever thread gets there last
+        auto keepLatest = [this](Index v, Index he) {
+            std::atomic_ref<Index> vertEdge(vertexEdge[v]);
+            Index prev = vertEdge.load(std::memory_order_relaxed);
+            while ((prev == NO_INDEX || prev < he) &&
+                   !vertEdge.compare_exchange_weak(prev, he, std::memory_order_relaxed)) {}
+        };
+        for (Index k = begin; k < end; k++) {
+            Index he1 = edgeHalf[k];
+            Index v1 = heVertex[he1];
+            Index he2 = heSym[he1];
+            Index v3 = V + F + k;
+            Index he1b = newHalfStart[k];
+
+            heVertex[he1b] = v1;  heFace[he1b] = heFace[he1];
+            heSym[he1b] = he2;   heNext[he1b] = heNext[he1];
+            heNext[he1] = he1b;  heVertex[he1] = v3;
+            keepLatest(v1, he1b);
+            vertexEdge[v3] = he1;
+
+            if (he2 != NO_INDEX) {
+                Index v2 = heVertex[he2];
+                Index he2b = he1b + 1;
+                heVertex[he2b] = v2;  heFace[he2b] = heFace[he2];
+                heSym[he2b] = he1;   heNext[he2b] = heNext[he2];
+                heSym[he1] = he2b;
+                heSym[he2] = he1b;   heNext[he2] = he2b;  heVertex[he2] = v3;
+                keepLatest(v2, he2b);
+                vertexEdge[v3] = he2;
+            }
+            if (hasSharpness()) {
+                float s = childSharpness(heSharpness[he1]);
+                heSharpness[he1] = heSharpness[he1b] = s;
+                if (he2 != NO_INDEX) heSharpness[he2] = heSharpness[he1b + 1] = s;
+            }
+            corners.forEach(*this, [&](auto& c, const auto& p) {
+                setSplitCorners(c, p, he1, he1b);
+                if (he2 != NO_INDEX) setSplitCorners(c, p, he2, he1b + 1);
+            });
+        }
+    });
+
+    parallelFor(V, [&](std::size_t begin, std::size_t end) {
+        std::copy(smoothed.begin() + begin, smoothed.begin() + end, positions.begin() + begin);
+    });
+
+    // step 4: quadrangulate, same as quadrangulateAllFaces but with each face's new faces/half-edges at its own offsets
+    parallelFor(F, [&](std::size_t begin, std::size_t end) {
+        std::vector<Index> edges;
+        for (Index origFace = begin; origFace < end; origFace++) {
+            Index centroid = V + origFace;
+
+            edges.clear();
+            Index c = faceEdge[origFace];
+            do {
+                edges.push_back(c);
+                c = heNext[c];
+            }
+            while(c != faceEdge[origFace]);
+            int n = edges.size();
+
+            // subface i/2 is origFace itself for i == 0, and new face newFaceStart[origFace] + i/2 - 1 after that
+            auto newFace = [&](int i) {return i == 0 ? origFace : newFaceStart[origFace] + i/2 - 1;};
+            for (int i = 1; i < n/2; i++) {
+                faceColors[newFace(2*i)] = faceColors[origFace];
+            }
+
+            const Index firstNewEdge = newEdgeStart[origFace];
+            for (int i = 0; i < n; i = i+2) {
+                Index a = firstNewEdge + i;
+                Index b = firstNewEdge + i + 1;
+
+                heVertex[a] = centroid;
+                heVertex[b] = heVertex[edges[((i-2)%n+n)%n]];
+                vertexEdge[centroid] = a;
+                corners.forEach(*this, [&](auto& c, const auto& p) {
+                    c[a] = p.atFace[origFace];
+                    c[b] = p.atEdge[edges[((i-2)%n+n)%n]];
+                });
+
+                Index cur = edges[i]; Index prev = edges[((i-1)%n+n)%n];
+                heNext[a] = b;
+                heNext[b] = prev;
+                heNext[prev] = cur;
+                heNext[cur] = a;
+
+                Index face = newFace(i);
+                heFace[a] = face;
+                heFace[b] = face;
+                heFace[cur] = face;
+                heFace[prev] = face;
+                faceEdge[face] = b;
+
+                if (i>=2) {
+                    Index lastA = a - 2;
+                    heSym[b] = lastA;
+                    heSym[lastA] = b;
+
+                    if (i == n-2) {
+                        Index firstB = firstNewEdge + 1;
+                        heSym[firstB] = a;
+                        heSym[a] = firstB;
+                    }
+                }
+            }
+        }
+    });
+}
+
+void HalfEdgeMesh::loopSubdivision() {
+    /*
+    One level of Loop subdivision: every triangle is cut into four, one at each corner and one in the middle, through
+    the midpoints of its edges. Triangles stay triangles, so the face count goes up four times per level
+    (catmullClark makes three quads of each triangle instead). Creases and boundaries follow subdivisionrules.h.
+    Like catmullClarkParallel, every new element's slot is fixed before anything is built:
+        vertices    midpoint of edge k at V+k
+        half-edges  edge k's new halves from newHalfStart[k] (two, or one on a boundary), then six inner half-edges
+                    per face
+        faces       the middle triangle keeps the index of the face, its three corners go to F+3f..F+3f+2
+    where edge k is as in edgeHalfEdges. So the mesh ends up with exactly V+E vertices, 4H half-edges (for a closed mesh)
+    and 4F faces, and the result doesn't depend on the number of threads.
+    */
+    for (Index f = 0; f < numFaces(); f++) {
+        if (faceDegree(f) != 3) {
+            LOG("loop subdivision needs a triangle mesh, triangulate it first");
+            return;
+        }
+    }
+    const Index V = numVertices();
+    const Index H = numHalfEdges();
+    const Index F = numFaces();
+
+    const std::vector<Index> edgeHalf = edgeHalfEdges();
+    const Index E = edgeHalf.size();
+
+    std::vector<Index> newHalfStart(E + 1);
+    newHalfStart[0] = H;
+    for (Index k = 0; k < E; k++) {
+        newHalfStart[k + 1] = newHalfStart[k] + (isBoundary(edgeHalf[k]) ? 1 : 2);
+    }
+    const Index innerStart = newHalfStart[E];
+    const Index numHalves = innerStart + 6*F;
+    LevelCorners corners(*this, true);
+
+    // step 1: the new positions, all from the mesh as it is now. the old vertices read each other's old positions,
+    // so theirs go to the side first
+    positions.resize(V + E);
+    vertexEdge.resize(V + E, NO_INDEX);
+    parallelFor(E, [&](std::size_t begin, std::size_t end) {
+        for (Index k = begin; k < end; k++) {
+            glm::vec3 p(0.f);
+            loopEdgePoint(*this, edgeHalf[k], [&](Index u, float w) {p += w*positions[u];});
+            positions[V + k] = p;
+        }
+    });
+    std::vector<glm::vec3> smoothed(V);
+    parallelFor(V, [&](std::size_t begin, std::size_t end) {
+        for (Index v = begin; v < end; v++) {
+            glm::vec3 p(0.f);
+            loopVertexPoint(*this, v, [&](Index u, float w) {p += w*positions[u];});
+            smoothed[v] = p;
+        }
+    });
+
+    heNext.resize(numHalves);
+    heSym.resize(numHalves);
+    heVertex.resize(numHalves);
+    heFace.resize(numHalves);
+    if (hasSharpness()) heSharpness.resize(numHalves, 0.f);
+    corners.forEach(*this, [&](auto& c, const auto&) {c.resize(numHalves);});
+    faceColors.resize(4*F);
+    faceEdge.resize(4*F);
+
+    // step 2: split every edge at its midpoint. the old half-edge keeps the first half, up to the midpoint,
+    // and the new one takes the rest
+    parallelFor(E, [&](std::size_t begin, std::size_t end) {
+        for (Index k = begin; k < end; k++) {
+            Index he1 = edgeHalf[k];
+            Index he2 = heSym[he1];
+            Index v1 = heVertex[he1];
+            Index mid = V + k;
+            Index he1b = newHalfStart[k];
+
+            heVertex[he1b] = v1;  heNext[he1b] = heNext[he1];
+            heSym[he1b] = he2;
+            heNext[he1] = he1b;  heVertex[he1] = mid;
+            vertexEdge[mid] = he1;
+            if (he2 != NO_INDEX) {
+                Index he2b = he1b + 1;
+                heVertex[he2b] = heVertex[he2];  heNext[he2b] = heNext[he2];
+                heSym[he2] = he1b;
+                heSym[he2b] = he1;  heSym[he1] = he2b;
+                heNext[he2] = he2b;  heVertex[he2] = mid;
+            }
+            if (hasSharpness()) {
+                float s = childSharpness(heSharpness[he1]);
+                heSharpness[he1] = heSharpness[he1b] = s;
+                if (he2 != NO_INDEX) heSharpness[he2] = heSharpness[he1b + 1] = s;
+            }
+            corners.forEach(*this, [&](auto& c, const auto& p) {
+                setSplitCorners(c, p, he1, he1b);
+                if (he2 != NO_INDEX) setSplitCorners(c, p, he2, he1b + 1);
+            });
+        }
+    });
+
+    // an old vertex's edge now stops at a midpoint, and the half after it comes back to the vertex
+    parallelFor(V, [&](std::size_t begin, std::size_t end) {
+        for (Index v = begin; v < end; v++) {
+            positions[v] = smoothed[v];
+            if (vertexEdge[v] != NO_INDEX) vertexEdge[v] = heNext[vertexEdge[v]];
+        }
+    });
+
+    // step 3: cut each face into four. the face's six half-edges are now first[i] from its corner i to midpoint i,
+    // then second[i] on from there to corner i+1
+    parallelFor(F, [&](std::size_t begin, std::size_t end) {
+        for (Index f = begin; f < end; f++) {
+            Index first[3], second[3], mid[3];
+            Index cur = faceEdge[f];
+            for (int i = 0; i < 3; i++) {
+                first[i] = cur;
+                second[i] = heNext[cur];
+                mid[i] = heVertex[cur];
+                cur = heNext[second[i]];
+            }
+
+            for (int i = 0; i < 3; i++) {
+                int j = (i + 1) % 3;
+                // outer[i] runs from mid[j] back to mid[i], closing the triangle at corner i+1.
+                // inner[i] runs the other way, around the middle triangle
+                Index outer = innerStart + 6*f + 2*i;
+                Index inner = outer + 1;
+                Index corner = F + 3*f + i;
+
+                heVertex[outer] = mid[i];
+                heVertex[inner] = mid[j];
+                heSym[outer] = inner;
+                heSym[inner] = outer;
+                // the same midpoints, in the same old face, as first[i] and first[j]
+                corners.forEach(*this, [&](auto& c, const auto& p) {
+                    c[outer] = p.atEdge[first[i]];
+                    c[inner] = p.atEdge[first[j]];
+                });
+
+                heNext[second[i]] = first[j];
+                heNext[first[j]] = outer;
+                heNext[outer] = second[i];
+                heFace[second[i]] = corner;
+                heFace[first[j]] = corner;
+                heFace[outer] = corner;
+                faceEdge[corner] = outer;
+                faceColors[corner] = faceColors[f];
+
+                heNext[inner] = innerStart + 6*f + 2*j + 1;
+                heFace[inner] = f;
+            }
+            faceEdge[f] = innerStart + 6*f + 1;
+        }
+    });
+    if (!hasCreases()) heSharpness.clear();
+}
+
+// key for the undirected edge between a and b. both half-edges of an edge get the same key
+static std::uint64_t edgeKey(Index a, Index b) {
+    return (std::uint64_t(std::min(a, b)) << 32) | std::max(a, b);
+}
+
+// fibonacci hashing: key * 2^64/phi, whose top bits are well mixed
+static std::uint64_t edgeHash(std::uint64_t key) {
+    return key * 0x9E3779B97F4A7C15ull;
+}
+
+Index HalfEdgeMesh::pairSyms(const std::vector<Index>& heSource) {
+    /*
+    Open-addressing hash table keyed on the undirected edge (min vertex, max vertex). Each slot holds the
+    first half-edge seen along that edge; the second one, running the other way, finds it and the two become syms.
+    A half-edge that never finds a partner is on the boundary and keeps sym == NO_INDEX.
+    The table is one flat allocation sized up front, so there is no per-entry allocation.
+
+    To run on several threads, the half-edges are first split into partitions by the top bits of their edge hash.
+    Both halves of an edge always land in the same partition, so each partition gets its own table and thread.
+    The split is stable (half-edges stay in index order within a partition), so which half-edges pair up
+    never depends on the number of threads.
+    */
+    struct Slot {
+        std::uint64_t key;
+        Index he;  // waiting for a partner, or NO_INDEX once paired (the key stays so probing still runs past it)
+    };
+    const std::uint64_t EMPTY = UINT64_MAX;
+    const Index numEdges = numHalfEdges();
+
+    int partitionBits = 0;
+    while ((1u << partitionBits) < threadCount() && partitionBits < 8) partitionBits++;
+    const std::size_t numPartitions = std::size_t(1) << partitionBits;
+    auto partitionOf = [partitionBits](std::uint64_t hash) {
+        return partitionBits == 0 ? 0 : std::size_t(hash >> (64 - partitionBits));
+    };
+
+    // counting sort of the half-edges by partition. each chunk counts its own half-edges first,
+    // so the scatter below can run per chunk and still keep index order
+    std::vector<Index> order(numEdges);
+    std::vector<std::size_t> partitionStart(numPartitions + 1, 0);
+    if (numPartitions == 1) {
+        for (Index he = 0; he < numEdges; he++) order[he] = he;
+        partitionStart[1] = numEdges;
+    } else {
+        const std::size_t numChunks = numPartitions;
+        std::vector<std::size_t> counts(numChunks * numPartitions, 0);
+        auto chunkBegin = [numEdges, numChunks](std::size_t c) {return Index(std::uint64_t(numEdges) * c / numChunks);};
+        parallelFor(numChunks, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t c = begin; c < end; c++) {
+                for (Index he = chunkBegin(c); he < chunkBegin(c + 1); he++) {
+                    counts[c * numPartitions + partitionOf(edgeHash(edgeKey(heSource[he], heVertex[he])))]++;
+                }
+            }
+        }, 1);
+        // offsets[c][p] = where chunk c writes its first half-edge of partition p
+        std::vector<std::size_t> offsets(numChunks * numPartitions);
+        std::size_t total = 0;
+        for (std::size_t p = 0; p < numPartitions; p++) {
+            partitionStart[p] = total;
+            for (std::size_t c = 0; c < numChunks; c++) {
+                offsets[c * numPartitions + p] = total;
+                total += counts[c * numPartitions + p];
+            }
+        }
+        partitionStart[numPartitions] = total;
+        parallelFor(numChunks, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t c = begin; c < end; c++) {
+                for (Index he = chunkBegin(c); he < chunkBegin(c + 1); he++) {
+                    std::size_t p = partitionOf(edgeHash(edgeKey(heSource[he], heVertex[he])));
+                    order[offsets[c * numPartitions + p]++] = he;
+                }
+            }
+        }, 1);
+    }
+
+    std::vector<Index> partitionBoundary(numPartitions, 0);
+    parallelFor(numPartitions, [&](std::size_t begin, std::size_t end) {
+        std::vector<Slot> table;
+        for (std::size_t p = begin; p < end; p++) {
+            const std::size_t size = partitionStart[p + 1] - partitionStart[p];
+            // one slot per half-edge can still be full when every edge is on the boundary, so give it twice that
+            std::size_t capacity = 2;
+            while (capacity < 2 * size) capacity <<= 1;
+            const std::size_t mask = capacity - 1;
+            const int shift = 64 - std::countr_zero(capacity);
+            table.assign(capacity, {EMPTY, NO_INDEX});
+
+            for (std::size_t i = partitionStart[p]; i < partitionStart[p + 1]; i++) {
+                Index he = order[i];
+                heSym[he] = NO_INDEX;
+                Index src = heSource[he];
+                Index dst = heVertex[he];
+                std::uint64_t key = edgeKey(src, dst);
+
+                // the top bits picked the partition, so index the table with the bits below them
+                std::size_t slot = (edgeHash(key) << partitionBits) >> shift;
+                while (true) {
+                    Slot& s = table[slot];
+                    if (s.key == EMPTY) {
+                        s = {key, he};
+                        break;
+                    }
+                    // only pair with an opposite half-edge. two half-edges running the same way along an edge
+                    // (flipped faces) or a third one (non-manifold edge) just wait for a partner of their own
+                    if (s.key == key && s.he != NO_INDEX && heSource[s.he] == dst && heVertex[s.he] == src) {
+                        heSym[he] = s.he;
+                        heSym[s.he] = he;
+                        s.he = NO_INDEX;
+                        break;
+                    }
+                    slot = (slot + 1) & mask;
+                }
+            }
+
+            for (std::size_t i = partitionStart[p]; i < partitionStart[p + 1]; i++) {
+                if (heSym[order[i]] == NO_INDEX) partitionBoundary[p]++;
+            }
+        }
+    }, 1);
+
+    Index numBoundary = 0;
+    for (Index n : partitionBoundary) numBoundary += n;
+    return numBoundary;
+}
+
+void HalfEdgeMesh::buildMesh(const std::vector<glm::vec3>& vertPositions, const std::vector<std::vector<int>>& faceIndices) {
+    // flatten into the layout the OBJ reader produces
+    ObjData obj;
+    obj.positions = vertPositions;
+    for (const auto& indices : faceIndices) {
+        obj.faceCorners.insert(obj.faceCorners.end(), indices.begin(), indices.end());
+        obj.faceStart.push_back(obj.faceCorners.size());
+    }
+    buildMesh(obj);
+}
+
+// true if every corner has an index into an array of the given size
+static bool allCornersValid(const std::vector<int>& cornerIndices, std::size_t numCorners, std::size_t size) {
+    if (cornerIndices.size() != numCorners) return false;
+    return std::all_of(cornerIndices.begin(), cornerIndices.end(),
+                       [size](int idx) {return idx >= 0 && std::size_t(idx) < size;});
+}
+
+// passed in from MyGL::loadOBJ
+void HalfEdgeMesh::buildMesh(const ObjData& obj) {
+    /*
+    Every face's half-edges are stored back to back, in the same order as its corners, so faceStart[f] is both
+    where face f's corners begin and the index of its first half-edge. With that, all arrays are sized once and faces
+    can be filled on any number of threads without touching each other. The result is the same as adding the faces one by one.
+    */
+    // reset the mesh
+    clear();
+
+    const std::vector<int>& faceCorners = obj.faceCorners;
+    const std::vector<Index>& faceStart = obj.faceStart;
+    const Index numVerts = obj.positions.size();
+    const Index numFaceIdx = obj.numFaces();
+    const Index numEdges = faceStart[numFaceIdx];
+
+    // uvs and normals are all or nothing: a mesh where only some corners have one is drawn without them
+    const bool useUVs = allCornersValid(obj.cornerUVs, numEdges, obj.uvs.size());
+    const bool useNormals = allCornersValid(obj.cornerNormals, numEdges, obj.normals.size());
+    if (!useUVs && !obj.cornerUVs.empty()) LOG("ignoring uvs, not every corner has a valid one");
+    if (!useNormals && !obj.cornerNormals.empty()) LOG("ignoring normals, not every corner has a valid one");
+
+    // First, fill out the vertices
+    positions = obj.positions;
+    vertexEdge.assign(numVerts, NO_INDEX);
+    // colors come from rand(), so draw them in face order on this thread to keep them reproducible
+    faceColors.resize(numFaceIdx);
+    for (Index f = 0; f < numFaceIdx; f++) {
+        faceColors[f] = glm::vec3(static_cast<float>(std::rand()) / RAND_MAX,
+                                  static_cast<float>(std::rand()) / RAND_MAX,
+                                  static_cast<float>(std::rand()) / RAND_MAX);
+    }
+    faceEdge.resize(numFaceIdx);
+    heNext.resize(numEdges);
+    heSym.resize(numEdges);
+    heVertex.resize(numEdges);
+    heFace.resize(numEdges);
+    if (useUVs) heUV.resize(numEdges);
+    if (useNormals) heNormal.resize(numEdges);
+
+    std::vector<Index> heSource(numEdges);  // the vertex each half-edge starts from, only needed to pair the syms
+
+    // Next, go through the faces and fill out their edges
+    parallelFor(numFaceIdx, [&](std::size_t begin, std::size_t end) {
+        for (Index f = begin; f < end; f++) {
+            const int* indices = faceCorners.data() + faceStart[f];  // n of them, the number of edges on that face
+            const Index n = faceStart[f + 1] - faceStart[f];
+            const Index firstEdge = faceStart[f];
+
+            for (Index i = 0; i < n; i++) {
+                Index he = firstEdge + i;
+                heFace[he] = f;
+                heVertex[he] = indices[(i+1)%n];  // using this modulo we can find the next vertex
+                heNext[he] = firstEdge + (i+1)%n;
+                heSource[he] = indices[i];
+                // a half-edge carries the corner it points to
+                Index corner = faceStart[f] + (i+1)%n;
+                if (useUVs) heUV[he] = obj.uvs[obj.cornerUVs[corner]];
+                if (useNormals) heNormal[he] = obj.normals[obj.cornerNormals[corner]];
+
+                // adding faces one at a time, the last half-edge to point at a vertex becomes its edge.
+                // keep the largest index so every thread agrees on the same answer
+                std::atomic_ref<Index> vertEdge(vertexEdge[heVertex[he]]);
+                Index prev = vertEdge.load(std::memory_order_relaxed);
+                while ((prev == NO_INDEX || prev < he) &&
+                       !vertEdge.compare_exchange_weak(prev, he, std::memory_order_relaxed)) {}
+            }
+            faceEdge[f] = firstEdge + n - 1;
+        }
+    });
+
+    // Now point the syms. boundary edges have no opposite and keep NO_INDEX
+    pairSyms(heSource);
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include <meshcomponents.h>
+#include <objreader.h>
+#include <vector>
+
+// how subdivision carries the corner attributes (uvs, normals) to the new corners
+enum class CornerInterpolation {
+    LINEAR,  // bilinear across each face: a new corner is the average of the old corners around it in the same face
+    SMOOTH,  // the same rules as the positions wherever the attribute is continuous, and linear along its seams and the
+             // boundary, so the borders of uv islands stay where they are
+};
+
+/*
+The half-edge mesh kernel. Instead of one heap object per vertex/face/half-edge linked with pointers,
+every attribute lives in its own contiguous array and connectivity is stored as 32-bit indices into them.
+So "he->next->sym->vertex" becomes heVertex[heSym[heNext[he]]], which walks flat memory instead of chasing pointers.
+Elements are only ever appended, never removed, so an index stays valid for the lifetime of the mesh.
+*/
+class HalfEdgeMesh
+{
+public:
+    // per vertex
+    std::vector<glm::vec3> positions;
+    std::vector<Index> vertexEdge;  // some half-edge pointing TO this vertex
+
+    // per face
+    std::vector<glm::vec3> faceColors;
+    std::vector<Index> faceEdge;    // some half-edge on the boundary of this face
+
+    // per half-edge
+    std::vector<Index> heNext;
+    std::vector<Index> heSym;
+    std::vector<Index> heVertex;    // the vertex this half-edge points to
+    std::vector<Index> heFace;
+    // per half-edge corner attributes from the OBJ's vt/vn lines, for the corner at the vertex the half-edge points to.
+    // empty when the mesh has none. an edge whose corners differ on its two sides is a seam of that attribute
+    std::vector<glm::vec2> heUV;
+    std::vector<glm::vec3> heNormal;
+    // how catmullClark, catmullClarkSelected and loopSubdivision interpolate heUV and heNormal
+    CornerInterpolation cornerInterpolation = CornerInterpolation::SMOOTH;
+    // per half-edge crease sharpness, the same on both halves of an edge. 0 is smooth, and each level of subdivision takes
+    // 1 off, so an edge of sharpness s stays sharp for s levels and then blends back into the surface. boundary edges are
+    // always sharp and don't need an entry. empty when every edge is smooth
+    std::vector<float> heSharpness;
+
+private:
+    // the new uvs and normals of one level of subdivision, worked out before it changes anything. see halfedgemesh.cpp
+    struct LevelCorners;
+
+    // the Catmull-Clark steps. faceCentroid[f] is the vertex added at face f's centroid
+    void computeAndAddCentroids(std::vector<Index>& faceCentroid, Index numFaces);
+    void addAllSmoothedMidpoints(const std::vector<Index>& faceCentroid, const std::vector<Index>& edgeHalf,
+                                 const LevelCorners& corners);
+    void smoothAllVertices(const std::vector<Index>& faceCentroid, Index numVerts, std::vector<glm::vec3>& smoothed);
+    void quadrangulateAllFaces(const std::vector<Index>& faceCentroid, Index numFaces, const LevelCorners& corners);
+    void addSmoothedMidpoint(Index, const glm::vec3& pos, const LevelCorners& corners);
+    // after an edge of sharpness s is split, both of its halves have s - 1 left (and at least 0)
+    void sharpenHalves(Index he1, Index he1b, float parent);
+    void cutIntoTriangles(Index f);
+    // catmullClark spread over threadCount() threads, see halfedgemesh.cpp
+    void catmullClarkParallel();
+
+    // sets heSym for every half-edge, given the vertex each one starts from. returns the number left unpaired
+    Index pairSyms(const std::vector<Index>& heSource);
+
+public:
+    Index numVertices() const {return positions.size();}
+    Index numFaces() const {return faceEdge.size();}
+    Index numHalfEdges() const {return heNext.size();}
+
+    Vertex vertex(Index v) const {return {v, positions[v], vertexEdge[v]};}
+    Face face(Index f) const {return {f, faceEdge[f], faceColors[f]};}
+    HalfEdge halfEdge(Index he) const {return {he, heNext[he], heSym[he], heFace[he], heVertex[he]};}
+
+    void clear();
+    Index addVertex(const glm::vec3&);
+    Index addFace(const glm::vec3& color);
+    Index addHalfEdge();
+
+    // point he at v, and make he the representative edge of v (same for faces)
+    void setVertex(Index he, Index v) {heVertex[he] = v; vertexEdge[v] = he;}
+    void setFace(Index he, Index f) {heFace[he] = f; faceEdge[f] = he;}
+
+    int faceDegree(Index f) const;
+    // the half-edge before he around its face. there is no prev pointer, so this walks the face
+    Index prevEdge(Index he) const;
+    // a boundary half-edge has no face on its other side
+    bool isBoundary(Index he) const {return heSym[he] == NO_INDEX;}
+    // every edge once, as the lower-indexed of its two half-edges (a boundary edge by its only one), in index order
+    std::vector<Index> edgeHalfEdges() const;
+    bool hasUVs() const {return !heUV.empty();}
+    bool hasNormals() const {return !heNormal.empty();}
+    bool hasSharpness() const {return !heSharpness.empty();}
+    // the vertex he starts from. a boundary half-edge has no sym to read it off, so that walks the face
+    Index sourceVertex(Index he) const {return isBoundary(he) ? heVertex[prevEdge(he)] : heVertex[heSym[he]];}
+    float sharpness(Index he) const {return hasSharpness() ? heSharpness[he] : 0.f;}
+    // sets the sharpness of he's edge (both halves)
+    void setSharpness(Index he, float s);
+    // true if any edge has a sharpness above 0
+    bool hasCreases() const;
+    // after v moved: sets the normal of every corner at v to the area-weighted average of the faces around it, leaving
+    // the rest of heNormal as it was. does nothing without normals
+    void updateVertexNormals(Index v);
+
+    // calls visit(he) once for every face around v, with he the half-edge of that face pointing to v. around a closed
+    // ring they come in the order heSym[heNext[he]] goes. an open one (v on a boundary) is walked from vertexEdge[v]
+    // to the boundary, then from vertexEdge[v] back the other way
+    template<class F>
+    void forEachIncoming(Index v, F&& visit) const {
+        const Index start = vertexEdge[v];
+        if (start == NO_INDEX) return;
+        Index cur = start;
+        do {
+            visit(cur);
+            cur = heSym[heNext[cur]];
+        } while (cur != start && cur != NO_INDEX);
+        if (cur == start) return;
+        cur = start;
+        while (!isBoundary(cur)) {
+            cur = prevEdge(heSym[cur]);
+            visit(cur);
+        }
+    }
+
+    void buildMesh(const std::vector<glm::vec3>&,
+                   const std::vector<std::vector<int>>&);
+    // same, from the flat arrays of the OBJ reader, also picking up its uvs and normals if every corner has one
+    void buildMesh(const ObjData&);
+
+    void splitEdge(Index he);
+    void triangulateFace(Index f);
+    void triangulateAllFaces();
+    // one level of Catmull-Clark. edges with a sharpness and the boundary of an open mesh are kept sharp, see
+    // subdivisionrules.h. uvs and normals are carried along in the same pass, by cornerInterpolation
+    void catmullClark();
+    // one level of Catmull-Clark on only the faces with refineFace set (one entry per face), leaving the rest of the
+    // mesh as it is but still crack-free. see adaptivesubdivision.h for choosing the faces
+    void catmullClarkSelected(const std::vector<bool>& refineFace);
+    // one level of Loop subdivision, each triangle into four, with the same crease and boundary rules as catmullClark.
+    // only for triangle meshes; anything else is left as it is
+    void loopSubdivision();
+};
@@ -0,0 +1,273 @@
+#include "limitsurface.h"
+#include "stenciltable.h"
+#include <algorithm>
+#include <cmath>
+
+bool limitVertices(const HalfEdgeMesh& mesh, std::vector<glm::vec3>& positions, std::vector<glm::vec3>& normals) {
+    StencilTable position, tangentU, tangentV;
+    if (!buildLimitStencils(mesh, position, tangentU, tangentV)) return false;
+    // everything is read from mesh.positions before either output is written, so positions may be mesh.positions
+    std::vector<glm::vec3> limit(mesh.numVertices()), du(mesh.numVertices()), dv(mesh.numVertices());
+    position.apply(mesh.positions, limit);
+    tangentU.apply(mesh.positions, du);
+    tangentV.apply(mesh.positions, dv);
+
+    normals.resize(mesh.numVertices());
+    for (Index v = 0; v < mesh.numVertices(); v++) {
+        glm::vec3 n = glm::cross(du[v], dv[v]);
+        float len = glm::length(n);
+        normals[v] = len > 0.f ? n / len : n;
+    }
+    positions.swap(limit);
+    return true;
+}
+
+/*
+A quad patch of the limit surface with its one extraordinary corner at (s,t) = (0,0), laid out as in Stam, "Exact
+Evaluation of Catmull-Clark Subdivision Surfaces at Arbitrary Parameter Values". The corner vertex v has n edge
+neighbours e[i] and n diagonal neighbours d[i], where v, e[i], d[i], e[i+1] is the i-th quad around v counterclockwise,
+quad 0 is the patch itself and e[0] is its (1,0) corner. Around the patch the control points sit on a grid p(i, j),
+i and j from -1 to 2, with v at p(0,0); the ring covers the ones next to v and x holds the seven beyond it.
+Only with n == 4 is there a point at p(-1,-1), d[2]; the patch is then a plain bicubic B-spline.
+*/
+struct LimitPatch
+{
+    int n;
+    glm::vec3 v;
+    std::vector<glm::vec3> e, d;
+    glm::vec3 x[7];     // p(2,-1), p(2,0), p(2,1), p(2,2), p(1,2), p(0,2), p(-1,2)
+
+    glm::vec3 p(int i, int j) const {
+        if (i == 2) return x[1 + j];
+        if (j == 2) return x[5 - i];
+        switch ((i + 1) * 3 + (j + 1)) {
+            case 0: return d[2];        // (-1,-1), only there when n == 4
+            case 1: return e[2 % n];    // (-1, 0)
+            case 2: return d[1];        // (-1, 1)
+            case 3: return e[n - 1];    // ( 0,-1)
+            case 4: return v;           // ( 0, 0)
+            case 5: return e[1];        // ( 0, 1)
+            case 6: return d[n - 1];    // ( 1,-1)
+            case 7: return e[0];        // ( 1, 0)
+            default: return d[0];       // ( 1, 1)
+        }
+    }
+    // centroid of the grid cell with p(i,j) as its lower corner
+    glm::vec3 facePoint(int i, int j) const {
+        return 0.25f * (p(i, j) + p(i + 1, j) + p(i + 1, j + 1) + p(i, j + 1));
+    }
+};
+
+// uniform cubic B-spline basis functions at t, and their derivatives
+static void bspline(float t, float b[4], float db[4]) {
+    float s = 1.f - t;
+    b[0] = s*s*s / 6.f;
+    b[1] = (3.f*t*t*t - 6.f*t*t + 4.f) / 6.f;
+    b[2] = (-3.f*t*t*t + 3.f*t*t + 3.f*t + 1.f) / 6.f;
+    b[3] = t*t*t / 6.f;
+    db[0] = -0.5f*s*s;
+    db[1] = 1.5f*t*t - 2.f*t;
+    db[2] = -1.5f*t*t + t + 0.5f;
+    db[3] = 0.5f*t*t;
+}
+
+// a regular patch given its 4x4 control points, grid[i][j] going along s with i
+static void evaluateBSpline(const glm::vec3 grid[4][4], float s, float t, glm::vec3& position, glm::vec3& normal) {
+    float bs[4], dbs[4], bt[4], dbt[4];
+    bspline(s, bs, dbs);
+    bspline(t, bt, dbt);
+    glm::vec3 ds(0.f), dt(0.f);
+    position = glm::vec3(0.f);
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            position += bs[i] * bt[j] * grid[i][j];
+            ds += dbs[i] * bt[j] * grid[i][j];
+            dt += bs[i] * dbt[j] * grid[i][j];
+        }
+    }
+    normal = glm::cross(ds, dt);
+}
+
+// the limit position and normal at the extraordinary corner itself, from the masks buildLimitStencils also uses
+static void evaluateCorner(const LimitPatch& patch, glm::vec3& position, glm::vec3& normal) {
+    const float PI = 3.14159265358979f;
+    const int n = patch.n;
+    float a = 2.f * PI / n;
+    float A = 1.f + std::cos(a) + std::cos(PI / n) * std::sqrt(2.f * (9.f + std::cos(a)));
+    glm::vec3 sumE(0.f), sumD(0.f), du(0.f), dv(0.f);
+    for (int i = 0; i < n; i++) {
+        sumE += patch.e[i];
+        sumD += patch.d[i];
+        du += A * std::cos(a * i) * patch.e[i] + (std::cos(a * i) + std::cos(a * (i + 1))) * patch.d[i];
+        dv += A * std::sin(a * i) * patch.e[i] + (std::sin(a * i) + std::sin(a * (i + 1))) * patch.d[i];
+    }
+    position = (float)(n * n) / (n * (n + 5)) * patch.v + (4.f * sumE + sumD) / (float)(n * (n + 5));
+    normal = glm::cross(du, dv);
+}
+
+// One Catmull-Clark step on the patch. The new grid q(i, j), i and j from -1 to 3, covers the four quarter-size patches
+// the old one splits into; q[i+1][j+1] is filled for every point but (-1,-1), and next becomes the quarter at the corner.
+static void subdividePatch(const LimitPatch& patch, glm::vec3 q[5][5], LimitPatch& next) {
+    const int n = patch.n;
+    next.n = n;
+    next.e.resize(n);
+    next.d.resize(n);
+    // the ring: face points of the quads around v, then midpoints of its edges, then v itself
+    glm::vec3 sumE(0.f), sumD(0.f);
+    for (int i = 0; i < n; i++) {
+        next.d[i] = 0.25f * (patch.v + patch.e[i] + patch.d[i] + patch.e[(i + 1) % n]);
+    }
+    for (int i = 0; i < n; i++) {
+        next.e[i] = 0.25f * (patch.v + patch.e[i] + next.d[(i + n - 1) % n] + next.d[i]);
+        sumE += patch.e[i];
+        sumD += next.d[i];
+    }
+    float frac = 1.f / n;
+    next.v = frac * (float)(n - 2) * patch.v + frac * frac * sumE + frac * frac * sumD;
+
+    auto at = [&q](int i, int j) -> glm::vec3& {return q[i + 1][j + 1];};
+    // face points of the old cells, at odd/odd
+    for (int i = -1; i <= 1; i++) {
+        for (int j = -1; j <= 1; j++) {
+            if (i == -1 && j == -1) continue;
+            at(2*i + 1, 2*j + 1) = patch.facePoint(i, j);
+        }
+    }
+    // midpoints of the old edges along i (at odd/even) and along j (at even/odd), each with the cells on either side.
+    // the ones on v's own edges are already in the ring
+    auto edgeI = [&](int i, int j) {return 0.25f * (patch.p(i, j) + patch.p(i + 1, j) + at(2*i + 1, 2*j - 1) + at(2*i + 1, 2*j + 1));};
+    auto edgeJ = [&](int i, int j) {return 0.25f * (patch.p(i, j) + patch.p(i, j + 1) + at(2*i - 1, 2*j + 1) + at(2*i + 1, 2*j + 1));};
+    at(-1, 0) = next.e[2 % n];
+    at(0, -1) = next.e[n - 1];
+    at(1, 0) = next.e[0];
+    at(0, 1) = next.e[1];
+    at(-1, 2) = edgeI(-1, 1);
+    at(1, 2) = edgeI(0, 1);
+    at(3, 0) = edgeI(1, 0);
+    at(3, 2) = edgeI(1, 1);
+    at(2, -1) = edgeJ(1, -1);
+    at(2, 1) = edgeJ(1, 0);
+    at(2, 3) = edgeJ(1, 1);
+    at(0, 3) = edgeJ(0, 1);
+    // the old vertices. all but v are regular, so (n-2)/n v + 1/n^2 (neighbours) + 1/n^2 (face points) with n = 4
+    auto regularVertex = [&](int i, int j) {
+        glm::vec3 neighbours = patch.p(i - 1, j) + patch.p(i + 1, j) + patch.p(i, j - 1) + patch.p(i, j + 1);
+        glm::vec3 faces = at(2*i - 1, 2*j - 1) + at(2*i + 1, 2*j - 1) + at(2*i - 1, 2*j + 1) + at(2*i + 1, 2*j + 1);
+        return 0.5f * patch.p(i, j) + (neighbours + faces) / 16.f;
+    };
+    at(0, 0) = next.v;
+    at(2, 0) = regularVertex(1, 0);
+    at(0, 2) = regularVertex(0, 1);
+    at(2, 2) = regularVertex(1, 1);
+
+    next.x[0] = at(2, -1);
+    next.x[1] = at(2, 0);
+    next.x[2] = at(2, 1);
+    next.x[3] = at(2, 2);
+    next.x[4] = at(1, 2);
+    next.x[5] = at(0, 2);
+    next.x[6] = at(-1, 2);
+}
+
+// number of sides of every face around vertex v, checking they are all quads. returns the valence, or 0 if not
+static int quadValence(const HalfEdgeMesh& mesh, Index v) {
+    int n = 0;
+    Index cur = mesh.vertexEdge[v];
+    do {
+        if (mesh.faceDegree(mesh.heFace[cur]) != 4) return 0;
+        n++;
+        cur = mesh.heSym[mesh.heNext[cur]];
+    } while (cur != mesh.vertexEdge[v]);
+    return n;
+}
+
+bool evaluateLimit(const HalfEdgeMesh& mesh, Index f, float u, float v, glm::vec3& position, glm::vec3& normal) {
+    if (std::find(mesh.heSym.begin(), mesh.heSym.end(), NO_INDEX) != mesh.heSym.end()) return false;
+    if (mesh.hasCreases()) return false;
+    if (mesh.faceDegree(f) != 4) return false;
+
+    // find the extraordinary corner, if any, and turn (u,v) so it is at (0,0)
+    Index corner[4];
+    corner[0] = mesh.faceEdge[f];
+    for (int k = 1; k < 4; k++) corner[k] = mesh.heNext[corner[k - 1]];
+    int k = 0;
+    int numExtraordinary = 0;
+    for (int c = 0; c < 4; c++) {
+        int n = quadValence(mesh, mesh.heVertex[corner[c]]);
+        if (n == 0) return false;
+        if (n != 4) {
+            k = c;
+            numExtraordinary++;
+        }
+    }
+    if (numExtraordinary > 1) return false;
+    float s = u, t = v;
+    for (int c = 0; c < k; c++) {
+        float turned = s;
+        s = t;
+        t = 1.f - turned;
+    }
+
+    // gather the patch. walking around v from the patch goes clockwise, through quads n-1, n-2, ...
+    const Index h = corner[k];
+    LimitPatch patch;
+    patch.n = quadValence(mesh, mesh.heVertex[h]);
+    patch.v = mesh.positions[mesh.heVertex[h]];
+    patch.e.resize(patch.n);
+    patch.d.resize(patch.n);
+    Index cur = h;
+    for (int j = 0; j < patch.n; j++) {
+        int i = (patch.n - j) % patch.n;
+        patch.e[i] = mesh.positions[mesh.heVertex[mesh.heNext[cur]]];
+        patch.d[i] = mesh.positions[mesh.heVertex[mesh.heNext[mesh.heNext[cur]]]];
+        cur = mesh.heSym[mesh.heNext[cur]];
+    }
+    // and the seven beyond, from the quads across the patch's far sides and past its far corners
+    auto pos = [&mesh](Index he) {return mesh.positions[mesh.heVertex[he]];};
+    auto nx = [&mesh](Index he) {return mesh.heNext[he];};
+    auto sym = [&mesh](Index he) {return mesh.heSym[he];};
+    Index side1 = sym(nx(nx(h)));           // in the quad across e[0]-d[0], from d[0] to e[0]
+    Index side2 = sym(nx(nx(nx(h))));       // in the quad across d[0]-e[1], from e[1] to d[0]
+    patch.x[1] = pos(nx(side1));
+    patch.x[2] = pos(nx(nx(side1)));
+    patch.x[4] = pos(nx(side2));
+    patch.x[5] = pos(nx(nx(side2)));
+    patch.x[0] = pos(nx(nx(sym(nx(side1)))));
+    patch.x[3] = pos(nx(sym(nx(nx(nx(side1))))));
+    patch.x[6] = pos(nx(sym(nx(nx(nx(side2))))));
+
+    // past a few dozen halvings (s,t) is as close to the corner as a float gets
+    const int MAX_DEPTH = 40;
+    glm::vec3 q[5][5];
+    for (int depth = 0; ; depth++) {
+        if (patch.n == 4) {
+            glm::vec3 grid[4][4];
+            for (int i = 0; i < 4; i++) for (int j = 0; j < 4; j++) grid[i][j] = patch.p(i - 1, j - 1);
+            evaluateBSpline(grid, s, t, position, normal);
+            break;
+        }
+        if ((s == 0.f && t == 0.f) || depth == MAX_DEPTH) {
+            evaluateCorner(patch, position, normal);
+            break;
+        }
+        LimitPatch quarter;
+        subdividePatch(patch, q, quarter);
+        if (s < 0.5f && t < 0.5f) {
+            // still in the quarter at the corner, which is extraordinary too
+            patch = std::move(quarter);
+            s *= 2.f;
+            t *= 2.f;
+            continue;
+        }
+        // one of the other three quarters, which are regular
+        int ci = s >= 0.5f ? 1 : 0;
+        int cj = t >= 0.5f ? 1 : 0;
+        glm::vec3 grid[4][4];
+        for (int i = 0; i < 4; i++) for (int j = 0; j < 4; j++) grid[i][j] = q[ci + i][cj + j];
+        evaluateBSpline(grid, 2.f * s - ci, 2.f * t - cj, position, normal);
+        break;
+    }
+    float len = glm::length(normal);
+    if (len > 0.f) normal /= len;
+    return true;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <halfedgemesh.h>
+#include <vector>
+
+/*
+The Catmull-Clark limit surface, evaluated directly instead of approximated by subdividing several levels.
+Both work on closed meshes without creases only: the masks here are for the smooth rules, so where catmullClark would
+keep an edge sharp (see subdivisionrules.h) they don't apply.
+*/
+
+// where every vertex of mesh ends up after subdividing forever, and the surface normal there (unit length, or zero for a
+// vertex on no face). Any polygons are fine, and positions may be mesh.positions itself to move the mesh onto the limit.
+// Returns false, writing nothing, if mesh has boundary or sharp edges
+bool limitVertices(const HalfEdgeMesh& mesh, std::vector<glm::vec3>& positions, std::vector<glm::vec3>& normals);
+
+// the limit surface at (u, v) on face f, with (0,0) at the vertex faceEdge[f] points to, (1,0) at the next corner and
+// (0,1) at the one before. f must be a quad with at most one extraordinary corner (valence other than 4) and only quads
+// around its corners. Every face is, after one catmullClark of an all-quad mesh or two of any other. Returns false if it isn't
+bool evaluateLimit(const HalfEdgeMesh& mesh, Index f, float u, float v, glm::vec3& position, glm::vec3& normal);
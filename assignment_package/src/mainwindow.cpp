@@ -7,15 +7,22 @@
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
-    ui(new Ui::MainWindow)
+    ui(new Ui::MainWindow),
+    m_vertsModel(MeshElementListModel::VERTICES, this),
+    m_facesModel(MeshElementListModel::FACES, this),
+    m_edgesModel(MeshElementListModel::HALFEDGES, this)
 {
     ui->setupUi(this);
     ui->mygl->setFocus();
 
+    ui->vertsListView->setModel(&m_vertsModel);
+    ui->facesListView->setModel(&m_facesModel);
+    ui->halfEdgesListView->setModel(&m_edgesModel);
+
     // we should only be able to select one vertex/face/edge at a time
-    ui->vertsListWidget->setSelectionMode(QAbstractItemView::SingleSelection);
-    ui->facesListWidget->setSelectionMode(QAbstractItemView::SingleSelection);
-    ui->halfEdgesListWidget->setSelectionMode(QAbstractItemView::SingleSelection);
+    ui->vertsListView->setSelectionMode(QAbstractItemView::SingleSelection);
+    ui->facesListView->setSelectionMode(QAbstractItemView::SingleSelection);
+    ui->halfEdgesListView->setSelectionMode(QAbstractItemView::SingleSelection);
 
     ui->faceRedSpinBox->blockSignals(true);
     ui->faceGreenSpinBox->blockSignals(true);
@@ -33,21 +40,26 @@ MainWindow::MainWindow(QWidget *parent) :
         // Slot name
         SLOT(slot_rebuildLists(const Mesh*)));
 
-    // connect to a slot here that casts the widget then passes it to mygl.
-    connect(ui->vertsListWidget,
-            &QListWidget::currentItemChanged,  // better than itemClicked()
+    connect(ui->mygl,
+        SIGNAL(sig_meshWasReplaced(const Mesh*)),
+        this,
+        SLOT(slot_resetLists(const Mesh*)));
+
+    // connect to a slot here that turns the row into an element id then passes it to mygl. row i is element i.
+    connect(ui->vertsListView->selectionModel(),
+            &QItemSelectionModel::currentChanged,  // better than clicked()
             this,
-            [this](QListWidgetItem* newVertex){if (!newVertex) return; slot_onVertexPicked(newVertex);});
+            [this](const QModelIndex& newVertex){if (!newVertex.isValid()) return; slot_onVertexPicked(newVertex.row());});
 
-    connect(ui->facesListWidget,
-            &QListWidget::currentItemChanged,
+    connect(ui->facesListView->selectionModel(),
+            &QItemSelectionModel::currentChanged,
             this,
-            [this](QListWidgetItem* newFace){if (!newFace) return; slot_onFacePicked(newFace);});
+            [this](const QModelIndex& newFace){if (!newFace.isValid()) return; slot_onFacePicked(newFace.row());});
 
-    connect(ui->halfEdgesListWidget,
-            &QListWidget::currentItemChanged,
+    connect(ui->halfEdgesListView->selectionModel(),
+            &QItemSelectionModel::currentChanged,
             this,
-            [this](QListWidgetItem* newEdge){if (!newEdge) return; slot_onEdgePicked(newEdge);});
+            [this](const QModelIndex& newEdge){if (!newEdge.isValid()) return; slot_onEdgePicked(newEdge.row());});
 
 
     // connect directly to slots in mygl to perform graph operations. we dont need to pass anything from here, so the slot lives there.
@@ -66,6 +78,11 @@ MainWindow::MainWindow(QWidget *parent) :
             ui->mygl,
             SLOT(slot_catmullClark()));
 
+    connect(ui->loopButton,
+            SIGNAL(clicked()),
+            ui->mygl,
+            SLOT(slot_loopSubdivision()));
+
     // change position of vertex using new Qt syntax
     connect(ui->vertPosXSpinBox,
             &QDoubleSpinBox::valueChanged,
@@ -97,6 +114,11 @@ MainWindow::MainWindow(QWidget *parent) :
             &QDoubleSpinBox::valueChanged,
             ui->mygl,
             [this](float val){ui->mygl->changeFaceColor(val, 'B');});
+
+    connect(ui->edgeSharpnessSpinBox,
+            &QDoubleSpinBox::valueChanged,
+            ui->mygl,
+            [this](float val){ui->mygl->changeEdgeSharpness(val);});
 }
 
 MainWindow::~MainWindow()
@@ -105,9 +127,9 @@ MainWindow::~MainWindow()
 }
 
 void MainWindow::resetAllWidgetValues() {
-    ui->vertsListWidget->clearSelection();
-    ui->halfEdgesListWidget->clearSelection();
-    ui->facesListWidget->clearSelection();
+    ui->vertsListView->clearSelection();
+    ui->halfEdgesListView->clearSelection();
+    ui->facesListView->clearSelection();
 
     ui->faceRedSpinBox->setValue(0.0);
     ui->faceGreenSpinBox->setValue(0.0);
@@ -115,6 +137,10 @@ void MainWindow::resetAllWidgetValues() {
     ui->vertPosXSpinBox->setValue(0.0);
     ui->vertPosYSpinBox->setValue(0.0);
     ui->vertPosZSpinBox->setValue(0.0);
+    // unlike the others this one stays connected, and zeroing it mustn't unsharpen whatever edge is still selected
+    ui->edgeSharpnessSpinBox->blockSignals(true);
+    ui->edgeSharpnessSpinBox->setValue(0.0);
+    ui->edgeSharpnessSpinBox->blockSignals(false);
 }
 
 void MainWindow::on_actionQuit_triggered()
@@ -124,54 +150,57 @@ void MainWindow::on_actionQuit_triggered()
 
 void MainWindow::on_actionOpenOBJ_triggered()
 {
-    resetAllWidgetValues();
+    // the lists are only reset once mygl actually replaces the mesh, so cancelling or a bad file leaves them be
     QString filename = QFileDialog::getOpenFileName(this, "Open .obj File", getCurrentPath());
     ui->mygl->loadOBJ(filename);  // pass it off to mygl
 }
 
+void MainWindow::on_actionOpenMesh_triggered()
+{
+    QString filename = QFileDialog::getOpenFileName(this, "Open Mesh", getCurrentPath(), "Half-edge mesh (*.hem)");
+    ui->mygl->loadMeshFile(filename);
+}
+
+void MainWindow::on_actionSaveMesh_triggered()
+{
+    QString filename = QFileDialog::getSaveFileName(this, "Save Mesh", getCurrentPath(), "Half-edge mesh (*.hem)");
+    if (filename.isEmpty()) return;
+    ui->mygl->saveMeshFile(filename);
+}
+
 void MainWindow::slot_rebuildLists(const Mesh* mesh) {
-    // here, traverse thru mesh->vertices, faces, edges and add to ui
-    for (const auto& vuptr : mesh->getVertices()) {
-        ui->vertsListWidget->addItem(vuptr.get());
-    }
-
-    for (const auto& fuptr : mesh->getFaces()) {
-        ui->facesListWidget->addItem(fuptr.get());
-    }
-
-    for (const auto& euptr : mesh->getEdges()) {
-        ui->halfEdgesListWidget->addItem(euptr.get());
-    }
+    // the models read straight from the mesh arrays, so all that changes after an appending edit is the number of
+    // rows. subdivision renumbers, and comes through slot_resetLists
+    m_vertsModel.sync(&mesh->getCore());
+    m_facesModel.sync(&mesh->getCore());
+    m_edgesModel.sync(&mesh->getCore());
+}
+
+void MainWindow::slot_resetLists(const Mesh* mesh) {
+    // a new mesh, so any old rows/selections are meaningless
+    resetAllWidgetValues();
+    m_vertsModel.reset(&mesh->getCore());
+    m_facesModel.reset(&mesh->getCore());
+    m_edgesModel.reset(&mesh->getCore());
 }
 
 // better UX: when selecting a new vertex, update the spinners with position
-void MainWindow::slot_onVertexPicked(QListWidgetItem* vertItem) {
-    // get vertex from vertItem
-    // set ui->mygl->selectvertex()
-    Vertex* vert = dynamic_cast<Vertex*>(vertItem);  // need a dynamic cast to get the child class
-
-    glm::vec3 pos = ui->mygl->selectVertex(vert);  // selects and returns position
-    ui->vertPosXSpinBox->setValue(pos.x);
-    ui->vertPosYSpinBox->setValue(pos.y);
-    ui->vertPosZSpinBox->setValue(pos.z);
+void MainWindow::slot_onVertexPicked(Index id) {
+    Vertex vert = ui->mygl->selectVertex(id);  // selects and returns a copy of the vertex
+    ui->vertPosXSpinBox->setValue(vert.pos.x);
+    ui->vertPosYSpinBox->setValue(vert.pos.y);
+    ui->vertPosZSpinBox->setValue(vert.pos.z);
 }
 
 // better UX
-void MainWindow::slot_onFacePicked(QListWidgetItem* faceItem) {
-    // get Face from faceItem
-    // set ui->mygl->selectFace()
-    Face* face = dynamic_cast<Face*>(faceItem);  // need a dynamic cast to get the child class
-
-    glm::vec3 col = ui->mygl->selectFace(face);
-    ui->faceRedSpinBox->setValue(col.r);
-    ui->faceGreenSpinBox->setValue(col.g);
-    ui->faceBlueSpinBox->setValue(col.b);
+void MainWindow::slot_onFacePicked(Index id) {
+    Face face = ui->mygl->selectFace(id);
+    ui->faceRedSpinBox->setValue(face.color.r);
+    ui->faceGreenSpinBox->setValue(face.color.g);
+    ui->faceBlueSpinBox->setValue(face.color.b);
 }
 
-void MainWindow::slot_onEdgePicked(QListWidgetItem* edgeItem) {
-    // get Edge from edgeItem
-    // set ui->mygl->selectEdge()
-    HalfEdge* edge = dynamic_cast<HalfEdge*>(edgeItem);  // need a dynamic cast to get the child class
-    ui->mygl->selectHalfEdge(edge);
+void MainWindow::slot_onEdgePicked(Index id) {
+    ui->mygl->selectHalfEdge(id);
+    ui->edgeSharpnessSpinBox->setValue(ui->mygl->selectedEdgeSharpness());
 }
-
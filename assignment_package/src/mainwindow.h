@@ -3,6 +3,7 @@
 
 #include <QMainWindow>
 #include <mesh.h>
+#include <meshlistmodel.h>
 
 
 namespace Ui {
@@ -21,15 +22,23 @@ public:
 private slots:
     void on_actionQuit_triggered();
     void on_actionOpenOBJ_triggered();
+    void on_actionOpenMesh_triggered();
+    void on_actionSaveMesh_triggered();
 
     // this connects to a signal in mygl after every build or rebuild
     void slot_rebuildLists(const Mesh* mesh);
-    void slot_onVertexPicked(QListWidgetItem* vertItem);
-    void slot_onFacePicked(QListWidgetItem* faceItem);
-    void slot_onEdgePicked(QListWidgetItem* edgeItem);
+    // and this one after a file replaces the whole mesh
+    void slot_resetLists(const Mesh* mesh);
+    void slot_onVertexPicked(Index vert);
+    void slot_onFacePicked(Index face);
+    void slot_onEdgePicked(Index edge);
 
 private:
     Ui::MainWindow *ui;
+    // back the three list panels directly with the mesh arrays
+    MeshElementListModel m_vertsModel;
+    MeshElementListModel m_facesModel;
+    MeshElementListModel m_edgesModel;
     void resetAllWidgetValues();
 };
 
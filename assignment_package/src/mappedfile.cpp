@@ -0,0 +1,61 @@
+#include "mappedfile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& path) {
+    // only a regular file counts as opened, and only once its bytes are mapped. an empty one has none to map
+#ifdef _WIN32
+    HANDLE f = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (f == INVALID_HANDLE_VALUE) return;
+    file = f;
+    LARGE_INTEGER size;
+    if (GetFileType(f) != FILE_TYPE_DISK || !GetFileSizeEx(f, &size)) return;
+    if (size.QuadPart == 0) {
+        opened = true;
+        return;
+    }
+    mapping = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) return;
+    bytes = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!bytes) return;
+    length = size.QuadPart;
+    opened = true;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        if (st.st_size == 0) {
+            opened = true;
+        } else {
+            void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                bytes = static_cast<const char*>(p);
+                length = st.st_size;
+                opened = true;
+                madvise(p, length, MADV_SEQUENTIAL);
+            }
+        }
+    }
+    close(fd);  // the mapping stays valid without the descriptor
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef _WIN32
+    if (bytes) UnmapViewOfFile(bytes);
+    if (mapping) CloseHandle(mapping);
+    if (file) CloseHandle(file);
+#else
+    if (bytes) munmap(const_cast<char*>(bytes), length);
+#endif
+}
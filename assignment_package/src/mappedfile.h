@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// A read-only view of a whole file, mapped into memory so readers work on the page cache directly
+class MappedFile
+{
+private:
+    const char* bytes = nullptr;
+    std::size_t length = 0;
+    bool opened = false;
+#ifdef _WIN32
+    void* file = nullptr;     // HANDLEs, kept as void* so windows.h stays out of this header
+    void* mapping = nullptr;
+#endif
+
+public:
+    MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // false if path isn't a regular file or couldn't be mapped. an empty file opens fine, it just has no bytes
+    bool isOpen() const {return opened;}
+    const char* begin() const {return bytes;}
+    const char* end() const {return bytes + length;}
+    std::size_t size() const {return length;}
+};
@@ -1,53 +1,118 @@
 #pragma once
 #include <utils.h>
-#include <meshcomponents.h>
+#include <halfedgemesh.h>
+#include <objreader.h>
+#include <stenciltable.h>
+#include <adaptivesubdivision.h>
+#include <limitsurface.h>
+#include <subdivisionhierarchy.h>
 #include <drawable.h>
 
 class Mesh : public Drawable
 {
     friend class MyGL;
 private:
-    std::vector<uPtr<Face>> faces;
-    std::vector<uPtr<Vertex>> vertices;
-    std::vector<uPtr<HalfEdge>> edges;
-
-    void computeAndAddCentroids(Mesh&,
-                                std::unordered_map<Face*, Vertex*>&,
-                                std::vector<Face*>&);
-    void addAllSmoothedMidpoints(Mesh&,
-                                std::unordered_map<Face*, Vertex*>&,
-                                std::vector<HalfEdge*>&);
-    void smoothAllVertices(Mesh& m,
-                           std::unordered_map<Face*, Vertex*>&,
-                           std::vector<Vertex*>&);
-    void quadrangulateAllFaces(Mesh& m,
-                               std::unordered_map<Face*, Vertex*>&,
-                               std::vector<Face*>&);
+    HalfEdgeMesh core;  // all vertices, faces and half-edges live here as flat arrays
+
+    // with a preview level above 0, core is kept as the control cage and a level of its subdivision is drawn instead.
+    // every level shown since the cage last changed is kept, and moving cage vertices re-evaluates them through their
+    // stencils, without subdividing again. see subdivisionhierarchy.h
+    int previewLevel = 0;
+    SubdivisionHierarchy hierarchy;
+
+    // with sharedVertices, every vertex is drawn once, shared by the faces around it, with the area-weighted average of
+    // their normals, instead of once per face corner with its face's normal
+    bool sharedVertices = false;
+
+    // where each drawn face starts in the buffers, from the last full upload: its first corner in the vertex buffer, or
+    // with sharedVertices its first index in the index buffer
+    std::vector<Index> faceCornerStart;
+
+    // the vertex buffers of a level that isn't on show. the one that is keeps its buffers in Drawable's, and the others
+    // wait in parkedBuffers (by level, 0 being the cage), so going back to a level is a swap instead of an upload
+    struct LevelBuffers
+    {
+        std::unordered_map<BufferType, GLuint> handles;
+        GLuint vao = 0;
+        int indexBufferLength = 0;
+        std::vector<Index> faceCornerStart;
+    };
+    std::vector<LevelBuffers> parkedBuffers;
+    // trades the buffers on show for the ones in b
+    void swapBuffers(LevelBuffers& b);
+    // deletes the parked buffers of every level from `first` up
+    void destroyParkedBuffers(int first);
+    // after a change to how the levels are made: drops every subdivided level and its buffers, and builds the one
+    // on show again
+    void rebuildLevels();
+
+    const HalfEdgeMesh& displayedMesh() const {return previewLevel > 0 ? hierarchy.level(previewLevel).mesh : core;}
+    // calls update(m, k) for every level k with buffers, with m the mesh of that level and its buffers on show (a parked
+    // level's are swapped in for the time being). update returns false if the buffers don't hold m's faces as they
+    // are; then the level on show is uploaded again, and a parked one is dropped until it is shown next
+    template<class F>
+    void updateLevelBuffers(F&& update);
+    // re-uploads the corners of the listed faces of m, which is drawn from the buffers on show. false if the buffers
+    // don't hold m's faces as they are
+    bool uploadFaces(const HalfEdgeMesh& m, std::vector<Index>& faces);
+    // the same with sharedVertices: re-uploads every vertex of the listed faces, whose normals and colors they feed into
+    void uploadFaceVertices(const HalfEdgeMesh& m, const std::vector<Index>& faces);
+    // pushes face f's corners, in the order they sit in the vertex buffer
+    static void appendFaceCorners(const HalfEdgeMesh& m, Index f, std::vector<GLVertex>& verts);
+    // fills the buffers of a shared-vertex upload: one vertex per vertex of m, and a triangle fan per face
+    void buildSharedVertices(const HalfEdgeMesh& m, std::vector<GLVertex>& verts, std::vector<GLuint>& idx);
 
 public:
     Mesh(OpenGLContext*);
+    ~Mesh() override;
     void buildMesh(const std::vector<glm::vec3>&,
                    const std::vector<std::vector<int>>&);
+    void buildMesh(const ObjData&);
     void initializeAndBufferGeometryData() override;
     void loadOBJ(QString&);
     GLenum drawMode() override;
 
-    void splitEdge(HalfEdge*);
-    void triangulateFace(Face*);
+    void splitEdge(Index he);
+    void triangulateFace(Index f);
     void catmullClark();
+    void loopSubdivision();
+    // sharpness of he's edge for subdivision, see HalfEdgeMesh::heSharpness
+    void setSharpness(Index he, float s);
 
-    void addSmoothedMidpoint(HalfEdge*, std::unordered_map<Face*, Vertex*>&);
-
-    const std::vector<uPtr<Face>>& getFaces() const {
-        return faces;
+    const HalfEdgeMesh& getCore() const {
+        return core;
     };
 
-    const std::vector<uPtr<Vertex>>& getVertices() const {
-        return vertices;
+    int getPreviewLevel() const {
+        return previewLevel;
     };
-
-    const std::vector<uPtr<HalfEdge>>& getEdges() const {
-        return edges;
+    // shows level `level` of the subdivision hierarchy (0 for the cage). a level shown before is drawn from the buffers
+    // it had then; otherwise it has none, and initializeAndBufferGeometryData uploads them
+    void setPreviewLevel(int level);
+    bool isPreviewAdaptive() const {
+        return hierarchy.isAdaptive();
     };
-};
+    void setPreviewAdaptive(bool adaptive, const AdaptiveCriteria& criteria);
+    bool isPreviewLimit() const {
+        return hierarchy.isLimit();
+    };
+    void setPreviewLimit(bool limit);
+    bool isSharedVertices() const {
+        return sharedVertices;
+    };
+    // switches between drawing a copy of every face corner and drawing every vertex once, smooth shaded. every level's
+    // buffers are dropped, so initializeAndBufferGeometryData has to upload the one on show
+    void setSharedVertices(bool shared);
 
+    // the limit surface of core, see limitsurface.h. false if core has boundary or sharp edges (or f isn't a patch it can evaluate)
+    bool computeLimit(std::vector<glm::vec3>& positions, std::vector<glm::vec3>& normals) const;
+    bool evaluateLimit(Index f, float u, float v, glm::vec3& position, glm::vec3& normal) const;
+    // call after anything but vertex positions changed in core, so the preview is subdivided again
+    void rebuildPreview();
+    // call after vertex v of core moved. every level with buffers, on show or parked, only has the part of it v affects
+    // recomputed and re-uploaded. corner normals from the file are recomputed around v and kept everywhere else
+    void vertexMoved(Index v);
+    // call after the color of face f of core changed. on every level with buffers only the faces cut from f are
+    // re-uploaded
+    void faceRecolored(Index f);
+};
@@ -2,29 +2,32 @@
 #include "debug.h"
 
 VertexDisplay::VertexDisplay(OpenGLContext* context)
-    : Drawable(context), representedVertex(nullptr)
+    : Drawable(context), mesh(nullptr), representedVertex(NO_INDEX)
 {}
 
 FaceDisplay::FaceDisplay(OpenGLContext* context)
-    : Drawable(context), representedFace(nullptr)
+    : Drawable(context), mesh(nullptr), representedFace(NO_INDEX)
 {}
 
 HalfEdgeDisplay::HalfEdgeDisplay(OpenGLContext* context)
-    : Drawable(context), representedHalfEdge(nullptr)
+    : Drawable(context), mesh(nullptr), representedHalfEdge(NO_INDEX)
 {}
 
 
-void VertexDisplay::updateVertex(Vertex* v) {
+void VertexDisplay::updateVertex(const HalfEdgeMesh& m, Index v) {
+    mesh = &m;
     representedVertex = v;
     initializeAndBufferGeometryData();
 }
 
-void FaceDisplay::updateFace(Face* f) {
+void FaceDisplay::updateFace(const HalfEdgeMesh& m, Index f) {
+    mesh = &m;
     representedFace = f;
     initializeAndBufferGeometryData();
 }
 
-void HalfEdgeDisplay::updateHalfEdge(HalfEdge* he) {
+void HalfEdgeDisplay::updateHalfEdge(const HalfEdgeMesh& m, Index he) {
+    mesh = &m;
     representedHalfEdge = he;
     initializeAndBufferGeometryData();
 }
@@ -33,18 +36,13 @@ void VertexDisplay::initializeAndBufferGeometryData() {
     destroyGPUData();
 
     // create a new, small vbo just for one vertex
-    std::vector<glm::vec3> pos = {representedVertex->pos};
-    std::vector<glm::vec3> col = {{1,1,1}};  // white
+    std::vector<GLVertex> verts = {{mesh->positions[representedVertex], {0,0,0}, {1,1,1}}};  // white
     std::vector<GLuint> idx = {0};
 
     // use the functions in drawable
-    generateBuffer(BufferType::POSITION);
-    bindBuffer(BufferType::POSITION);
-    bufferData(BufferType::POSITION, pos);
-
-    generateBuffer(BufferType::COLOR);
-    bindBuffer(BufferType::COLOR);
-    bufferData(BufferType::COLOR, col);
+    generateBuffer(BufferType::VERTEX);
+    bindBuffer(BufferType::VERTEX);
+    bufferData(BufferType::VERTEX, verts);
 
     generateBuffer(BufferType::INDEX);
     bindBuffer(BufferType::INDEX);
@@ -56,33 +54,27 @@ void VertexDisplay::initializeAndBufferGeometryData() {
 void FaceDisplay::initializeAndBufferGeometryData() {
     destroyGPUData();
 
-    std::vector<glm::vec3> pos;
-    std::vector<glm::vec3> col;
+    std::vector<GLVertex> verts;
     std::vector<GLuint> idx;  // 0,1,1,2,2,3...
 
-    glm::vec3 line_color = 1.f - (representedFace->color);
+    glm::vec3 line_color = 1.f - (mesh->faceColors[representedFace]);
 
-    HalfEdge* cur = representedFace->edge;
+    Index cur = mesh->faceEdge[representedFace];
     int i = 0;
     do {
-        pos.push_back(cur->vertex->pos);
-        col.push_back(line_color);
+        verts.push_back({mesh->positions[mesh->heVertex[cur]], {0,0,0}, line_color});
         idx.push_back(i); idx.push_back(i+1);
-        cur = cur->next;
+        cur = mesh->heNext[cur];
         i++;
-    } while (cur != representedFace->edge);
+    } while (cur != mesh->faceEdge[representedFace]);
 
     idx.pop_back();
     idx.push_back(0);  // want to end in a loop: 011220 for example
 
     // use the functions in drawable
-    generateBuffer(BufferType::POSITION);
-    bindBuffer(BufferType::POSITION);
-    bufferData(BufferType::POSITION, pos);
-
-    generateBuffer(BufferType::COLOR);
-    bindBuffer(BufferType::COLOR);
-    bufferData(BufferType::COLOR, col);
+    generateBuffer(BufferType::VERTEX);
+    bindBuffer(BufferType::VERTEX);
+    bufferData(BufferType::VERTEX, verts);
 
     generateBuffer(BufferType::INDEX);
     bindBuffer(BufferType::INDEX);
@@ -94,19 +86,15 @@ void FaceDisplay::initializeAndBufferGeometryData() {
 void HalfEdgeDisplay::initializeAndBufferGeometryData() {
     destroyGPUData();
 
-    // create a new, small vbo just for one edge
-    std::vector<glm::vec3> pos = {representedHalfEdge->sym->vertex->pos, representedHalfEdge->vertex->pos};
-    std::vector<glm::vec3> col = {{1,0,0},{1,1,0}};  // red->yellow
+    // create a new, small vbo just for one edge. a boundary half-edge has no sym, so its start comes from its face loop
+    std::vector<GLVertex> verts = {{mesh->positions[mesh->sourceVertex(representedHalfEdge)], {0,0,0}, {1,0,0}},
+                                   {mesh->positions[mesh->heVertex[representedHalfEdge]], {0,0,0}, {1,1,0}}};  // red->yellow
     std::vector<GLuint> idx = {0,1};
 
     // use the functions in drawable
-    generateBuffer(BufferType::POSITION);
-    bindBuffer(BufferType::POSITION);
-    bufferData(BufferType::POSITION, pos);
-
-    generateBuffer(BufferType::COLOR);
-    bindBuffer(BufferType::COLOR);
-    bufferData(BufferType::COLOR, col);
+    generateBuffer(BufferType::VERTEX);
+    bindBuffer(BufferType::VERTEX);
+    bufferData(BufferType::VERTEX, verts);
 
     generateBuffer(BufferType::INDEX);
     bindBuffer(BufferType::INDEX);
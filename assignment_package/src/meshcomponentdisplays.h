@@ -1,18 +1,19 @@
 #pragma once
-#include <meshcomponents.h>
+#include <halfedgemesh.h>
 #include "drawable.h"
 
 class VertexDisplay : public Drawable {
 protected:
-    Vertex *representedVertex;
+    const HalfEdgeMesh *mesh;
+    Index representedVertex;
 
 public:
     VertexDisplay(OpenGLContext*);
     // Creates VBO data to make a visual
     // representation of the currently selected Vertex
     void initializeAndBufferGeometryData() override;
-    // Change which Vertex representedVertex points to
-    void updateVertex(Vertex*);
+    // Change which vertex of the mesh representedVertex refers to
+    void updateVertex(const HalfEdgeMesh&, Index);
 
     GLenum drawMode() override {
         return GL_POINTS;
@@ -21,15 +22,16 @@ public:
 
 class FaceDisplay : public Drawable {
 protected:
-    Face *representedFace;
+    const HalfEdgeMesh *mesh;
+    Index representedFace;
 
 public:
     FaceDisplay(OpenGLContext*);
     // Creates VBO data to make a visual
     // representation of the currently selected Face
     void initializeAndBufferGeometryData() override;
-    // Change which Face representedFace points to
-    void updateFace(Face*);
+    // Change which face of the mesh representedFace refers to
+    void updateFace(const HalfEdgeMesh&, Index);
 
     GLenum drawMode() override {
         return GL_LINES;
@@ -38,15 +40,16 @@ public:
 
 class HalfEdgeDisplay : public Drawable {
 protected:
-    HalfEdge *representedHalfEdge;
+    const HalfEdgeMesh *mesh;
+    Index representedHalfEdge;
 
 public:
     HalfEdgeDisplay(OpenGLContext*);
     // Creates VBO data to make a visual
     // representation of the currently selected HalfEdge
     void initializeAndBufferGeometryData() override;
-    // Change which HalfEdge representedHalfEdge points to
-    void updateHalfEdge(HalfEdge*);
+    // Change which half-edge of the mesh representedHalfEdge refers to
+    void updateHalfEdge(const HalfEdgeMesh&, Index);
 
     GLenum drawMode() override {
         return GL_LINES;
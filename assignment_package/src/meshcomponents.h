@@ -1,71 +1,40 @@
 #pragma once
 #include <glm/glm.hpp>
-#include <QListWidgetItem>
+#include <cstdint>
+#include <type_traits>
 
-class HalfEdge;
+// every element of the mesh is referred to by its position in the HalfEdgeMesh arrays
+using Index = std::uint32_t;
+constexpr Index NO_INDEX = UINT32_MAX;
 
-class Vertex : public QListWidgetItem
-{
-    friend class HalfEdge;
-    friend class Mesh;
-    friend class VertexDisplay;
-    friend class FaceDisplay;
-    friend class HalfEdgeDisplay;
-    friend class MyGL;
+// Plain copies of one element's data, as returned by HalfEdgeMesh::vertex()/face()/halfEdge().
+// They carry no Qt state or vtable, so they are cheap to pass around and safe to use without a GUI.
 
-private:
+struct Vertex
+{
+    Index id;
     glm::vec3 pos;
-    HalfEdge* edge;
-    const int id;
-    static int last_created;
-
-public:
-    Vertex(float, float, float);
-    Vertex(const glm::vec3&);
+    Index edge;     // some half-edge pointing TO this vertex
 };
 
-class Face : public QListWidgetItem
+struct Face
 {
-    friend class Mesh;
-    friend class HalfEdge;
-    friend class FaceDisplay;
-    friend class MyGL;
-
-private:
-    HalfEdge* edge;
+    Index id;
+    Index edge;     // some half-edge on the boundary of this face
     glm::vec3 color;
-    const int id;
-    static int last_created;
-
-public:
-    Face();
 };
 
-class HalfEdge : public QListWidgetItem
+struct HalfEdge
 {
-    friend class Mesh;
-    friend class FaceDisplay;
-    friend class HalfEdgeDisplay;
-    friend class MyGL;
-
-private:
-    HalfEdge* next;
-    HalfEdge* sym;
-    Face* face;
-    Vertex* vertex;
-    const int id;
-    static int last_created;
-
-public:
-    HalfEdge();
-
-    void setVertex(Vertex* v) {
-        this->vertex = v;
-        v->edge = this;
-    }
-
-    void setFace(Face* f) {
-        this->face = f;
-        f->edge = this;
-    }
+    Index id;
+    Index next;
+    Index sym;
+    Index face;
+    Index vertex;   // the vertex this half-edge points to
 };
+
+// the bundled glm spells out vec3's copy constructor, so the standard won't call Vertex/Face
+// trivially copyable, but all three are plain layouts with nothing to destroy
+static_assert(std::is_standard_layout_v<Vertex> && std::is_trivially_destructible_v<Vertex>);
+static_assert(std::is_standard_layout_v<Face> && std::is_trivially_destructible_v<Face>);
+static_assert(std::is_trivially_copyable_v<HalfEdge>);
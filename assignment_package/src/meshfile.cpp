@@ -0,0 +1,155 @@
+#include "meshfile.h"
+#include "mappedfile.h"
+#include "parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+
+struct MeshFileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t flags;
+    std::uint32_t numVertices;
+    std::uint32_t numFaces;
+    std::uint32_t numHalfEdges;
+    std::uint32_t reserved;
+};
+static_assert(sizeof(MeshFileHeader) == 32);
+// the arrays are dumped as they sit in memory, which only works if glm packs its vectors tightly
+static_assert(sizeof(glm::vec2) == 8 && sizeof(glm::vec3) == 12);
+
+static const char MESH_FILE_MAGIC[8] = {'H', 'E', 'M', 'E', 'S', 'H', 0, 0};
+static const std::uint32_t HAS_UVS = 1;
+static const std::uint32_t HAS_NORMALS = 2;
+static const std::uint32_t HAS_SHARPNESS = 4;
+static const std::uint32_t KNOWN_FLAGS = HAS_UVS | HAS_NORMALS | HAS_SHARPNESS;
+
+// everything in the file is 32-bit words, so on a big-endian machine every word is swapped and that's all
+static const bool NEEDS_SWAP = std::endian::native != std::endian::little;
+
+static void swapWords(void* data, std::size_t bytes) {
+    std::uint32_t* words = static_cast<std::uint32_t*>(data);
+    for (std::size_t i = 0; i < bytes / 4; i++) {
+        std::uint32_t w = words[i];
+        words[i] = (w >> 24) | ((w >> 8) & 0xFF00) | ((w << 8) & 0xFF0000) | (w << 24);
+    }
+}
+
+static bool writeWords(std::FILE* file, const void* data, std::size_t bytes) {
+    if (bytes == 0) return true;
+    if (!NEEDS_SWAP) return std::fwrite(data, 1, bytes, file) == bytes;
+    // swap a block at a time instead of copying the whole array
+    std::uint32_t block[4096];
+    const char* p = static_cast<const char*>(data);
+    while (bytes > 0) {
+        std::size_t n = std::min(bytes, sizeof(block));
+        std::memcpy(block, p, n);
+        swapWords(block, n);
+        if (std::fwrite(block, 1, n, file) != n) return false;
+        p += n;
+        bytes -= n;
+    }
+    return true;
+}
+
+template <typename T>
+static bool writeArray(std::FILE* file, const std::vector<T>& array) {
+    return writeWords(file, array.data(), array.size() * sizeof(T));
+}
+
+bool writeMeshFile(const std::string& path, const HalfEdgeMesh& mesh) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+
+    MeshFileHeader header = {};
+    std::memcpy(header.magic, MESH_FILE_MAGIC, sizeof(header.magic));
+    header.version = MESH_FILE_VERSION;
+    header.flags = (mesh.hasUVs() ? HAS_UVS : 0) | (mesh.hasNormals() ? HAS_NORMALS : 0) |
+                   (mesh.hasSharpness() ? HAS_SHARPNESS : 0);
+    header.numVertices = mesh.numVertices();
+    header.numFaces = mesh.numFaces();
+    header.numHalfEdges = mesh.numHalfEdges();
+
+    bool ok = std::fwrite(header.magic, 1, sizeof(header.magic), file) == sizeof(header.magic) &&
+              writeWords(file, &header.version, sizeof(header) - sizeof(header.magic)) &&
+              writeArray(file, mesh.positions) && writeArray(file, mesh.vertexEdge) &&
+              writeArray(file, mesh.faceColors) && writeArray(file, mesh.faceEdge) &&
+              writeArray(file, mesh.heNext) && writeArray(file, mesh.heSym) &&
+              writeArray(file, mesh.heVertex) && writeArray(file, mesh.heFace) &&
+              writeArray(file, mesh.heUV) && writeArray(file, mesh.heNormal) &&
+              writeArray(file, mesh.heSharpness);
+    ok = std::fclose(file) == 0 && ok;
+    return ok;
+}
+
+// copies count elements out of the mapped file at p, and moves p past them.
+// every array starts on a 4-byte boundary of the (page aligned) mapping, so the words can be read in place.
+// assigning straight from the mapping also skips zero-filling the vector first
+template <typename T>
+static void readArray(const char*& p, std::vector<T>& array, std::size_t count) {
+    const T* src = reinterpret_cast<const T*>(p);
+    array.assign(src, src + count);
+    if (NEEDS_SWAP) swapWords(array.data(), count * sizeof(T));
+    p += count * sizeof(T);
+}
+
+// true if every index in `array` is below count, or NO_INDEX where that is allowed
+static bool indicesInRange(const std::vector<Index>& array, std::size_t count, bool allowNoIndex) {
+    std::atomic<bool> ok = true;
+    parallelFor(array.size(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end && ok.load(std::memory_order_relaxed); i++) {
+            if (array[i] >= count && !(allowNoIndex && array[i] == NO_INDEX)) ok = false;
+        }
+    });
+    return ok;
+}
+
+// The size check only proves the arrays are all there; an index in them could still point anywhere, and every
+// traversal of the mesh follows them unchecked. Only heSym (boundary) and vertexEdge (unused vertex) may be NO_INDEX.
+static bool validIndices(const HalfEdgeMesh& mesh) {
+    const std::size_t V = mesh.numVertices(), F = mesh.numFaces(), H = mesh.numHalfEdges();
+    return indicesInRange(mesh.vertexEdge, H, true) && indicesInRange(mesh.faceEdge, H, false) &&
+           indicesInRange(mesh.heNext, H, false) && indicesInRange(mesh.heSym, H, true) &&
+           indicesInRange(mesh.heVertex, V, false) && indicesInRange(mesh.heFace, F, false);
+}
+
+bool readMeshFile(const std::string& path, HalfEdgeMesh& mesh) {
+    MappedFile file(path);
+    if (!file.isOpen() || file.size() < sizeof(MeshFileHeader)) return false;
+
+    MeshFileHeader header;
+    std::memcpy(&header, file.begin(), sizeof(header));
+    if (NEEDS_SWAP) swapWords(&header.version, sizeof(header) - sizeof(header.magic));
+    if (std::memcmp(header.magic, MESH_FILE_MAGIC, sizeof(header.magic)) != 0) return false;
+    if (header.version != MESH_FILE_VERSION) return false;
+    if (header.flags & ~KNOWN_FLAGS) return false;
+
+    const std::uint64_t V = header.numVertices, F = header.numFaces, H = header.numHalfEdges;
+    const bool hasUVs = header.flags & HAS_UVS;
+    const bool hasNormals = header.flags & HAS_NORMALS;
+    const bool hasSharpness = header.flags & HAS_SHARPNESS;
+    const std::uint64_t expected = sizeof(header) + V * 16 + F * 16 + H * 16 +
+                                   (hasUVs ? H * 8 : 0) + (hasNormals ? H * 12 : 0) + (hasSharpness ? H * 4 : 0);
+    if (file.size() != expected) return false;
+
+    // read into a mesh of our own so a file that turns out to be bad leaves `mesh` as it was
+    const char* p = file.begin() + sizeof(header);
+    HalfEdgeMesh read;
+    readArray(p, read.positions, V);
+    readArray(p, read.vertexEdge, V);
+    readArray(p, read.faceColors, F);
+    readArray(p, read.faceEdge, F);
+    readArray(p, read.heNext, H);
+    readArray(p, read.heSym, H);
+    readArray(p, read.heVertex, H);
+    readArray(p, read.heFace, H);
+    readArray(p, read.heUV, hasUVs ? H : 0);
+    readArray(p, read.heNormal, hasNormals ? H : 0);
+    readArray(p, read.heSharpness, hasSharpness ? H : 0);
+    if (!validIndices(read)) return false;
+    std::swap(mesh, read);
+    return true;
+}
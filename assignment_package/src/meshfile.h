@@ -0,0 +1,24 @@
+#pragma once
+#include <halfedgemesh.h>
+#include <string>
+
+/*
+The native .hem format: the HalfEdgeMesh arrays written out exactly as they are in memory, so saving is a
+straight dump and loading is a copy out of the mapped file with no parsing and no rebuild of the connectivity.
+
+    header (32 bytes)   "HEMESH\0\0", u32 version, u32 flags, u32 numVertices, u32 numFaces, u32 numHalfEdges, u32 reserved
+    per vertex          positions (3 x f32), vertexEdge (u32)
+    per face            faceColors (3 x f32), faceEdge (u32)
+    per half-edge       heNext, heSym, heVertex, heFace (u32 each), then heUV (2 x f32), heNormal (3 x f32) and
+                        heSharpness (f32) if flagged
+
+Every value is a 32-bit little-endian word and each array follows the previous one with no padding.
+NO_INDEX is stored as 0xFFFFFFFF. A file that isn't exactly the size its header says, has flags this version doesn't
+know, or has an index past the end of the array it points into is rejected.
+*/
+const std::uint32_t MESH_FILE_VERSION = 1;
+
+// Returns false if the file could not be written
+bool writeMeshFile(const std::string& path, const HalfEdgeMesh& mesh);
+// Returns false if the file could not be opened or is not a valid .hem file; `mesh` is only changed on success
+bool readMeshFile(const std::string& path, HalfEdgeMesh& mesh);
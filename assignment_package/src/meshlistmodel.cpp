@@ -0,0 +1,55 @@
+#include "meshlistmodel.h"
+
+MeshElementListModel::MeshElementListModel(ElementType type, QObject *parent)
+    : QAbstractListModel(parent),
+      mesh(nullptr), type(type), rows(0)
+{}
+
+int MeshElementListModel::elementCount() const {
+    if (!mesh) return 0;
+    switch (type) {
+        case VERTICES:
+            return mesh->numVertices();
+        case FACES:
+            return mesh->numFaces();
+        case HALFEDGES:
+            return mesh->numHalfEdges();
+    }
+    return 0;
+}
+
+int MeshElementListModel::rowCount(const QModelIndex &parent) const {
+    // flat list, so nothing has children
+    return parent.isValid() ? 0 : rows;
+}
+
+QVariant MeshElementListModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= rows) return QVariant();
+    // the label is just the element id, built only when the view paints this row
+    if (role == Qt::DisplayRole) return QString::number(index.row());
+    return QVariant();
+}
+
+void MeshElementListModel::reset(const HalfEdgeMesh* m) {
+    beginResetModel();
+    mesh = m;
+    rows = elementCount();
+    endResetModel();
+}
+
+void MeshElementListModel::sync(const HalfEdgeMesh* m) {
+    if (m != mesh) {
+        reset(m);
+        return;
+    }
+    int count = elementCount();
+    if (count == rows) return;
+    if (count < rows) {
+        // only happens if the mesh was rebuilt underneath us
+        reset(mesh);
+        return;
+    }
+    beginInsertRows(QModelIndex(), rows, count - 1);
+    rows = count;
+    endInsertRows();
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <halfedgemesh.h>
+#include <QAbstractListModel>
+
+// A list model over one kind of element of a HalfEdgeMesh. Row i is element i, and the view
+// only asks for the rows it is showing, so no per-element objects are ever created.
+class MeshElementListModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    enum ElementType {VERTICES, FACES, HALFEDGES};
+
+private:
+    const HalfEdgeMesh *mesh;
+    ElementType type;
+    int rows;  // the row count the attached views were last told about
+
+    int elementCount() const;
+
+public:
+    MeshElementListModel(ElementType, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    // Point the model at a (possibly different) mesh and drop all rows and selections
+    void reset(const HalfEdgeMesh*);
+    // Catch up with an edit that only appended elements (splitting an edge, triangulating a face), so this just
+    // announces the new rows at the end and existing selections stay put. Subdivision renumbers faces and
+    // half-edges, and a different mesh replaces everything: both go through reset instead
+    void sync(const HalfEdgeMesh*);
+};
@@ -4,17 +4,15 @@
 #include <QApplication>
 #include <QKeyEvent>
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <string>
 #include <debug.h>
+#include <meshfile.h>
 
 MyGL::MyGL(QWidget *parent)
     : OpenGLContext(parent),
-      timer(), currTime(0.),
       m_geomSquare(this),
       m_progLambert(this), m_progFlat(this),
-      vao(),
+      m_lambertModel(-1), m_lambertModelInvTr(-1), m_flatModel(-1), m_cameraBuffer(0),
       m_camera(width(), height()),
       m_mousePosPrev(),
       m_vertDisplay(this),
@@ -24,38 +22,38 @@ MyGL::MyGL(QWidget *parent)
     setFocusPolicy(Qt::StrongFocus);
 
     m_mesh = std::make_unique<Mesh>(this);  // create the mesh object
-
-    connect(&timer, SIGNAL(timeout()), this, SLOT(tick()));
-    // Tell the timer to redraw 60 times per second
-    timer.start(16);
+    // nothing repaints on a timer: every change calls markDirty, which asks Qt for one frame
 }
 
 MyGL::~MyGL()
 {
     makeCurrent();
-    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &m_cameraBuffer);
 }
 
 void MyGL::slot_splitEdge() {
     // perform the mesh operation
-    if (!m_selectedHalfEdge) return;
+    if (m_selectedHalfEdge == NO_INDEX) return;
     m_mesh->splitEdge(m_selectedHalfEdge);
+    // the cage looks the same, but a preview of it is subdivided differently now
+    if (m_mesh->getPreviewLevel() > 0) m_mesh->initializeAndBufferGeometryData();
     // update m_edgeDisplay just to rebuffer data (could also just call initandbuffer())
-    m_edgeDisplay.updateHalfEdge(m_selectedHalfEdge);
-    // call update() to update display
-    update();
+    m_edgeDisplay.updateHalfEdge(m_mesh->core, m_selectedHalfEdge);
+    // schedule a repaint
+    markDirty(DIRTY_MESH | DIRTY_SELECTION);
     // emit signal to mainwindow to update lists. we're unnecesarily reforming the whole list, but it doens't really matter
     emit sig_meshWasBuiltOrRebuilt(m_mesh.get());
 }
 
 void MyGL::slot_triangulateFace() {
     // perform the mesh operation
-    if (!m_selectedFace) return;
+    if (m_selectedFace == NO_INDEX) return;
     m_mesh->triangulateFace(m_selectedFace);
+    if (m_mesh->getPreviewLevel() > 0) m_mesh->initializeAndBufferGeometryData();
     // possibly update m_[thing]display
-    m_faceDisplay.updateFace(m_selectedFace);
-    // call update() to update display
-    update();
+    m_faceDisplay.updateFace(m_mesh->core, m_selectedFace);
+    // schedule a repaint
+    markDirty(DIRTY_MESH | DIRTY_SELECTION);
     // emit signal to mainwindow to update lists
     emit sig_meshWasBuiltOrRebuilt(m_mesh.get());
 }
@@ -63,125 +61,128 @@ void MyGL::slot_triangulateFace() {
 void MyGL::slot_catmullClark() {
     // perform the mesh operation
     m_mesh->catmullClark();
-    // then rebuffer all three small vert/face/edge displays
-    if (m_selectedFace) m_faceDisplay.updateFace(m_selectedFace);
-    if (m_selectedHalfEdge) m_edgeDisplay.updateHalfEdge(m_selectedHalfEdge);
-    if (m_selectedVertex) m_vertDisplay.updateVertex(m_selectedVertex);
-    m_mesh->initializeAndBufferGeometryData();
-    update();
-    emit sig_meshWasBuiltOrRebuilt(m_mesh.get());
+    // subdivision renumbers the faces and half-edges, so the selection and the list rows are as stale as after a load
+    meshWasReplaced();
+}
+
+void MyGL::slot_loopSubdivision() {
+    // same as catmull-clark: faces and half-edges are renumbered, so start over with the selection
+    m_mesh->loopSubdivision();
+    meshWasReplaced();
 }
 
-glm::vec3 MyGL::selectVertex(Vertex* v) {
+Vertex MyGL::selectVertex(Index v) {
     m_selectedVertex = v;
-    m_vertDisplay.updateVertex(v);
+    m_vertDisplay.updateVertex(m_mesh->core, v);
     // we must trigger the whole mesh to be redrawn.
     // might be unintuitive at first, because we can draw it on top, so occlusions/depth calc doesnt even matter here
     // but its not possible to glClear only a single VBO's contributions after its drawn unless you somehow keep track of it in the framebuffer
-    // and we must update() the whole mesh, including this vertex, anyway at a high frame rate, so trying to hack it is beyond not worth it
-    update();
-    return v->pos;
+    // and we must redraw the whole mesh, including this vertex, anyway, so trying to hack it is beyond not worth it
+    markDirty(DIRTY_SELECTION);
+    return m_mesh->core.vertex(v);
 }
 
-glm::vec3 MyGL::selectFace(Face* f) {
+Face MyGL::selectFace(Index f) {
     m_selectedFace = f;
-    m_faceDisplay.updateFace(f);
-    update();
+    m_faceDisplay.updateFace(m_mesh->core, f);
+    markDirty(DIRTY_SELECTION);
 
-    return f->color;
+    return m_mesh->core.face(f);
 }
 
-void MyGL::selectHalfEdge(HalfEdge* he) {
+void MyGL::selectHalfEdge(Index he) {
     m_selectedHalfEdge = he;
-    m_edgeDisplay.updateHalfEdge(he);
-    update();
+    m_edgeDisplay.updateHalfEdge(m_mesh->core, he);
+    markDirty(DIRTY_SELECTION);
+}
+
+float MyGL::selectedEdgeSharpness() const {
+    return m_selectedHalfEdge == NO_INDEX ? 0.f : m_mesh->core.sharpness(m_selectedHalfEdge);
 }
 
 void MyGL::changeVertexPosition(float val, char direction) {
     switch (direction) {
         case 'X':
-            m_selectedVertex->pos.x = val;
+            m_mesh->core.positions[m_selectedVertex].x = val;
             break;
         case 'Y':
-            m_selectedVertex->pos.y = val;
+            m_mesh->core.positions[m_selectedVertex].y = val;
             break;
         case 'Z':
-            m_selectedVertex->pos.z = val;
+            m_mesh->core.positions[m_selectedVertex].z = val;
             break;
     }
-    // must update VBO. for now lets just change the whole thing
-    m_mesh->initializeAndBufferGeometryData();
-    update();
+    // every level built only gets the patch this vertex moves recomputed and re-uploaded, its normals included
+    m_mesh->vertexMoved(m_selectedVertex);
+    markDirty(DIRTY_MESH);
 };
 
 void MyGL::changeFaceColor(float val, char channel) {
     switch (channel) {
         case 'R':
-            m_selectedFace->color.r = val;
+            m_mesh->core.faceColors[m_selectedFace].r = val;
             break;
         case 'G':
-            m_selectedFace->color.g = val;
+            m_mesh->core.faceColors[m_selectedFace].g = val;
             break;
         case 'B':
-            m_selectedFace->color.b = val;
+            m_mesh->core.faceColors[m_selectedFace].b = val;
             break;
         }
+    // only the corners of this face, and of the faces cut from it on every level built, get re-uploaded
+    m_mesh->faceRecolored(m_selectedFace);
+    markDirty(DIRTY_MESH);
+}
+
+void MyGL::changeEdgeSharpness(float val) {
+    // picking an edge sets the spin box to its sharpness, which shouldn't cost a resubdivision
+    if (m_selectedHalfEdge == NO_INDEX || m_mesh->core.sharpness(m_selectedHalfEdge) == val) return;
+    m_mesh->setSharpness(m_selectedHalfEdge, val);
     m_mesh->initializeAndBufferGeometryData();
-    update();
+    markDirty(DIRTY_MESH);
 }
 
 
 void MyGL::loadOBJ(const QString& path) {
-    std::ifstream objfile(path.toStdString());
-    if (!objfile.is_open()) {std::cout << "Unable to open file"; return;}
-
-    std::vector<glm::vec3> positions;
-    std::vector<std::vector<int>> faceIndices;  // can store faces with arb many sides
-
     /*
-    Here is the main logic of the file parsing. For each line, we check the first token of the line.
-    Depending on whether the line starts with "v" or "f", we either push the positions into the positions vector above,
-    or collect the relevant indices of the vertices into the faceIndices vector.
+    The file is memory-mapped and parsed in place (see objreader.cpp): positions, uvs and normals go into flat arrays,
+    and every face's corner indices go back to back into others, with faceStart marking where each face begins.
     We can then pass in this information to a Mesh class function to build the half-edge mesh graph.
     */
-    std::string line;
-    while (std::getline(objfile, line)) {
-        std::istringstream iss(line);
-        std::string first;
-        iss >> first;  // streams until whitespace, so will get the first word (v, f, vn, etc)
-
-        if (first == "v") {
-            float x, y, z;
-            iss >> x >> y >> z;
-            positions.push_back(glm::vec3(x,y,z));
-        }
-        else if (first == "f") {
-            std::vector<int> verts;
-            std::string vertexStr;
-            while (iss >> vertexStr) {  // get just one string of pos/uv/normal
-                std::replace(vertexStr.begin(), vertexStr.end(), '/', ' ');
-                std::istringstream vs(vertexStr);
-                int posIndex;
-                vs >> posIndex;  // vs just streams the first number into posindex
-                verts.push_back(posIndex - 1);
-            }
-            faceIndices.push_back(verts);
-        }
-        else continue;
-    }
+    ObjData obj;
+    if (!readOBJ(path.toStdString(), obj)) {std::cout << "Unable to open file"; return;}
 
     // Now, we build the m_mesh object
-    m_mesh->buildMesh(positions, faceIndices);
+    m_mesh->buildMesh(obj);
+    meshWasReplaced();
+}
 
-    // Trigger the rebuild slot for the non-MyGl ui widget
-    emit sig_meshWasBuiltOrRebuilt(m_mesh.get());
+void MyGL::loadMeshFile(const QString& path) {
+    // a .hem file already holds the finished connectivity, so it goes straight into the mesh arrays (see meshfile.h)
+    if (!readMeshFile(path.toStdString(), m_mesh->core)) {std::cout << "Unable to open mesh file"; return;}
+    m_mesh->rebuildPreview();
+    meshWasReplaced();
+}
+
+void MyGL::saveMeshFile(const QString& path) {
+    if (!writeMeshFile(path.toStdString(), m_mesh->core)) {std::cout << "Unable to save mesh file"; return;}
+}
+
+void MyGL::meshWasReplaced() {
+    // the old selection indexes into the old mesh, and so do its highlights
+    m_selectedVertex = m_selectedHalfEdge = m_selectedFace = NO_INDEX;
+    m_vertDisplay.destroyGPUData();
+    m_edgeDisplay.destroyGPUData();
+    m_faceDisplay.destroyGPUData();
+
+    // Trigger the reset slot for the non-MyGl ui widget
+    emit sig_meshWasReplaced(m_mesh.get());
 
     // Buffer the data
     m_mesh->initializeAndBufferGeometryData();
 
     // Update and repaint the screen
-    update();
-
+    markDirty(DIRTY_MESH | DIRTY_SELECTION);
 }
 
 void MyGL::initializeGL()
@@ -205,9 +206,6 @@ void MyGL::initializeGL()
 
     printGLErrorLog();
 
-    // Create a Vertex Attribute Object
-    glGenVertexArrays(1, &vao);
-
     //Create the instances of Cylinder and Sphere.
     m_geomSquare.initializeAndBufferGeometryData();
 
@@ -215,11 +213,23 @@ void MyGL::initializeGL()
     m_progLambert.createAndCompileShaderProgram("lambert.vert.glsl", "lambert.frag.glsl");
     // Create and set up the flat lighting shader
     m_progFlat.createAndCompileShaderProgram("flat.vert.glsl", "flat.frag.glsl");
+    // every Drawable has its own VAO, which ShaderProgram::draw binds
+
+    m_lambertModel = m_progLambert.getUniformHandle("u_Model");
+    m_lambertModelInvTr = m_progLambert.getUniformHandle("u_ModelInvTr");
+    m_flatModel = m_progFlat.getUniformHandle("u_Model");
 
+    // both shaders' Camera blocks are linked to CAMERA_BLOCK_BINDING, so binding the buffer there once serves them all
+    glGenBuffers(1, &m_cameraBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, m_cameraBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlock), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_BLOCK_BINDING, m_cameraBuffer);
+}
 
-    // We have to have a VAO bound in OpenGL 3.2 Core. But if we're not
-    // using multiple VAOs, we can just bind one once.
-    glBindVertexArray(vao);
+void MyGL::uploadCamera() {
+    CameraBlock camera = {m_camera.getViewProj(), glm::vec4(m_camera.eye, 1.f)};
+    glBindBuffer(GL_UNIFORM_BUFFER, m_cameraBuffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraBlock), &camera);
 }
 
 void MyGL::resizeGL(int w, int h)
@@ -228,10 +238,8 @@ void MyGL::resizeGL(int w, int h)
     //our scene's camera view.
     m_camera.recomputeAspectRatio(w, h);
 
-    // Upload the view-projection matrix to our shaders (i.e. onto the graphics card)
-    glm::mat4 viewproj = m_camera.getViewProj();
-    m_progLambert.setUnifMat4("u_ViewProj", viewproj);
-    m_progFlat.setUnifMat4("u_ViewProj", viewproj);
+    // the view-projection matrix is uploaded to our shaders (i.e. onto the graphics card) with the next frame
+    markDirty(DIRTY_CAMERA);
 
     printGLErrorLog();
 }
@@ -243,13 +251,10 @@ void MyGL::paintGL()
     // Clear the screen so that we only see newly drawn images
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    glm::mat4 viewproj = m_camera.getViewProj();
-    // glm::mat4 model = glm::mat4(1.f);
-    m_progLambert.setUnifMat4("u_ViewProj", viewproj);
-    m_progFlat.setUnifMat4("u_ViewProj", viewproj);
-    m_progLambert.setUnifVec3("u_CamPos", m_camera.eye);
-    m_progFlat.setUnifMat4("u_Model", glm::mat4(1.f));
-    m_progLambert.setUnifMat4("u_Model", glm::mat4(1.f));
+    // the buffers of the mesh and the selection are already up to date; only the camera is sent here
+    if (m_dirty.beginFrame() & DIRTY_CAMERA) uploadCamera();
+    m_progFlat.setUnifMat4(m_flatModel, glm::mat4(1.f));
+    m_progLambert.setUnifMat4(m_lambertModel, glm::mat4(1.f));
 
     if (m_mesh && m_mesh->getIndexBufferLength() > 0) {  // only display if set
         m_progLambert.draw(*m_mesh);  // binds to existing buffers
@@ -269,16 +274,16 @@ void MyGL::paintGL()
     //implemented row-major matrices.
     glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(-2,0,0)) * glm::rotate(glm::mat4(), 0.25f * 3.14159f, glm::vec3(0,1,0));
     //Send the geometry's transformation matrix to the shader
-    m_progLambert.setUnifMat4("u_Model", model);
-    m_progLambert.setUnifMat4("u_ModelInvTr", glm::inverse(glm::transpose(model)));
+    m_progLambert.setUnifMat4(m_lambertModel, model);
+    m_progLambert.setUnifMat4(m_lambertModelInvTr, glm::inverse(glm::transpose(model)));
     //Draw the example sphere using our lambert shader
     m_progLambert.draw(m_geomSquare);
 
     //Now do the same to render the cylinder
     //We've rotated it -45 degrees on the Z axis, then translated it to the point <2,2,0>
     model = glm::translate(glm::mat4(1.0f), glm::vec3(2,2,0)) * glm::rotate(glm::mat4(1.0f), glm::radians(-45.0f), glm::vec3(0,0,1));
-    m_progLambert.setUnifMat4("u_Model", model);
-    m_progLambert.setUnifMat4("u_ModelInvTr", glm::inverse(glm::transpose(model)));
+    m_progLambert.setUnifMat4(m_lambertModel, model);
+    m_progLambert.setUnifMat4(m_lambertModelInvTr, glm::inverse(glm::transpose(model)));
     m_progLambert.draw(m_geomSquare);
 }
 
@@ -286,28 +291,87 @@ void MyGL::keyPressEvent(QKeyEvent *e) {
     switch (e->key()) {
         case Qt::Key_N:
             LOG("N");
-            if (m_edgeDisplay.getIndexBufferLength() > 0) selectHalfEdge(m_selectedHalfEdge->next);
+            if (m_selectedHalfEdge != NO_INDEX) selectHalfEdge(m_mesh->core.halfEdge(m_selectedHalfEdge).next);
             break;
         case Qt::Key_M:
             LOG("M");
-            if (m_edgeDisplay.getIndexBufferLength() > 0) selectHalfEdge(m_selectedHalfEdge->sym);
+            // a boundary half-edge has no sym to go to
+            if (m_selectedHalfEdge != NO_INDEX && !m_mesh->core.isBoundary(m_selectedHalfEdge)) {
+                selectHalfEdge(m_mesh->core.halfEdge(m_selectedHalfEdge).sym);
+            }
             break;
         case Qt::Key_F:
             LOG("F");
-            if (m_edgeDisplay.getIndexBufferLength() > 0) selectFace(m_selectedHalfEdge->face);
+            if (m_selectedHalfEdge != NO_INDEX) selectFace(m_mesh->core.halfEdge(m_selectedHalfEdge).face);
             break;
         case Qt::Key_V:
             LOG("V");
-            if (m_edgeDisplay.getIndexBufferLength() > 0) selectVertex(m_selectedHalfEdge->vertex);
+            if (m_selectedHalfEdge != NO_INDEX) selectVertex(m_mesh->core.halfEdge(m_selectedHalfEdge).vertex);
+            break;
+        case Qt::Key_P:
+            // P / Shift P: draw the mesh subdivided one level more / less, keeping the current mesh as the cage
+            if (e->modifiers() & Qt::ShiftModifier) {
+                LOG("Shift P");
+                m_mesh->setPreviewLevel(m_mesh->getPreviewLevel() - 1);
+            } else {
+                LOG("P");
+                m_mesh->setPreviewLevel(std::min(m_mesh->getPreviewLevel() + 1, MAX_PREVIEW_LEVEL));
+            }
+            // a level shown before still has its buffers
+            if (!m_mesh->hasBuffer(INDEX)) m_mesh->initializeAndBufferGeometryData();
+            markDirty(DIRTY_MESH);
+            break;
+        case Qt::Key_0:
+        case Qt::Key_1:
+        case Qt::Key_2:
+        case Qt::Key_3:
+        case Qt::Key_4:
+            // 0-4: jump straight to that preview level, 0 being the cage
+            LOG(e->text().toStdString());
+            m_mesh->setPreviewLevel(e->key() - Qt::Key_0);
+            if (!m_mesh->hasBuffer(INDEX)) m_mesh->initializeAndBufferGeometryData();
+            markDirty(DIRTY_MESH);
+            break;
+        case Qt::Key_A: {
+            // A: switch the preview between refining everything and refining only around extraordinary vertices,
+            // sharp bends, and the face selected at the time
+            LOG("A");
+            AdaptiveCriteria criteria;
+            if (m_selectedFace != NO_INDEX) {
+                criteria.selectedFaces.assign(m_mesh->core.numFaces(), false);
+                criteria.selectedFaces[m_selectedFace] = true;
+            }
+            criteria.maxBendDegrees = ADAPTIVE_PREVIEW_BEND;
+            m_mesh->setPreviewAdaptive(!m_mesh->isPreviewAdaptive(), criteria);
+            if (!m_mesh->hasBuffer(INDEX)) m_mesh->initializeAndBufferGeometryData();
+            markDirty(DIRTY_MESH);
+            break;
+        }
+        case Qt::Key_L:
+            // L: put the preview on the limit surface, or take it off. one level and the limit stand in for several levels
+            LOG("L");
+            if (m_mesh->getPreviewLevel() == 0) m_mesh->setPreviewLevel(1);
+            m_mesh->setPreviewLimit(!m_mesh->isPreviewLimit());
+            if (!m_mesh->hasBuffer(INDEX)) m_mesh->initializeAndBufferGeometryData();
+            markDirty(DIRTY_MESH);
+            break;
+        case Qt::Key_S:
+            // S: draw every vertex once with a smooth normal, or a copy per face corner with its face's normal
+            LOG("S");
+            m_mesh->setSharedVertices(!m_mesh->isSharedVertices());
+            m_mesh->initializeAndBufferGeometryData();
+            markDirty(DIRTY_MESH);
             break;
         case Qt::Key_H:
             if (e->modifiers() & Qt::ShiftModifier) {
                 LOG("Shift H");
-                if (m_faceDisplay.getIndexBufferLength() > 0) selectHalfEdge(m_selectedFace->edge);
+                if (m_selectedFace != NO_INDEX) selectHalfEdge(m_mesh->core.face(m_selectedFace).edge);
                 break;
             } else {
                 LOG("H");
-                if (m_vertDisplay.getIndexBufferLength() > 0) selectHalfEdge(m_selectedVertex->edge);
+                if (m_selectedVertex != NO_INDEX && m_mesh->core.vertex(m_selectedVertex).edge != NO_INDEX) {
+                    selectHalfEdge(m_mesh->core.vertex(m_selectedVertex).edge);
+                }
                 break;
             }
     }
@@ -338,13 +402,16 @@ void MyGL::mouseMoveEvent(QMouseEvent *e) {
         m_camera.PanAlongRight(-diff.x);
         m_camera.PanAlongUp(diff.y);
     }
+    else return;
+    markDirty(DIRTY_CAMERA);
 }
 
 void MyGL::wheelEvent(QWheelEvent *e) {
     m_camera.Zoom(e->angleDelta().y() * 0.001f);
+    markDirty(DIRTY_CAMERA);
 }
 
-void MyGL::tick() {
-    ++currTime;
-    update();
+void MyGL::markDirty(unsigned flags) {
+    // a burst of edits between two frames asks for one paint event, and draws once
+    if (m_dirty.mark(flags)) update();
 }
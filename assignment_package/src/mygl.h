@@ -9,25 +9,29 @@
 
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLShaderProgram>
-#include <QTimer>
 #include <mesh.h>
+#include <dirtyflags.h>
 #include "meshcomponentdisplays.h"
 
 
+// deepest subdivision preview the P key goes to. each level has four times the faces of the one before
+const int MAX_PREVIEW_LEVEL = 4;
+// an adaptive preview (A key) also refines where neighbouring faces bend by more than this many degrees
+const float ADAPTIVE_PREVIEW_BEND = 15.f;
+
 class MyGL
     : public OpenGLContext
 {
     Q_OBJECT
 private:
-    QTimer timer;
-    float currTime;
-
     SquarePlane m_geomSquare;// The instance of a unit cylinder we can use to render any cylinder
     ShaderProgram m_progLambert;// A shader program that uses lambertian reflection
     ShaderProgram m_progFlat;// A shader program that uses "flat" reflection (no shadowing at all)
-
-    GLuint vao; // A handle for our vertex array object. This will store the VBOs created in our geometry classes.
-                // Don't worry too much about this. Just know it is necessary in order to render geometry.
+    // the uniforms set per draw, looked up once the shaders are compiled
+    GLint m_lambertModel, m_lambertModelInvTr, m_flatModel;
+    // the Camera uniform block both shaders read, written once per frame
+    GLuint m_cameraBuffer;
+    void uploadCamera();
 
     Camera m_camera;
     // A variable used to track the mouse's previous position when
@@ -37,10 +41,15 @@ private:
 
     uPtr<Mesh> m_mesh;  // stores the mesh
 
-    Vertex* m_selectedVertex = nullptr;
-    HalfEdge* m_selectedHalfEdge = nullptr;
-    Face* m_selectedFace = nullptr;
+    Index m_selectedVertex = NO_INDEX;
+    Index m_selectedHalfEdge = NO_INDEX;
+    Index m_selectedFace = NO_INDEX;
 
+    // clears the selection and rebuffers after m_mesh got a whole new mesh, or one subdivided into new numbering
+    void meshWasReplaced();
+
+    // what changed since the last frame, and how many frames there have been
+    DirtyFlags m_dirty;
 
 public:
     explicit MyGL(QWidget *parent = nullptr);
@@ -50,14 +59,24 @@ public:
     void resizeGL(int w, int h);
     void paintGL();
     void loadOBJ(const QString& path);
+    void loadMeshFile(const QString& path);
+    void saveMeshFile(const QString& path);
 
     // called by mainwindow
-    glm::vec3 selectVertex(Vertex* v);
-    void selectHalfEdge(HalfEdge* he);
-    glm::vec3 selectFace(Face* f);
+    Vertex selectVertex(Index v);
+    void selectHalfEdge(Index he);
+    float selectedEdgeSharpness() const;
+    Face selectFace(Index f);
 
     void changeVertexPosition(float, char);
     void changeFaceColor(float, char);
+    void changeEdgeSharpness(float);
+
+    // schedules a repaint for the changes in `flags` (see DirtyFlag). any number of calls before the next frame give
+    // one repaint
+    void markDirty(unsigned flags);
+    // the number of frames painted so far, to check that nothing repaints while nothing changes
+    unsigned long long frameCount() const {return m_dirty.frameCount();}
 
     VertexDisplay m_vertDisplay;
     FaceDisplay m_faceDisplay;
@@ -72,12 +91,15 @@ protected:
     // expose a signal to mainwindow to rebuild the lists
 signals:
     void sig_meshWasBuiltOrRebuilt(const Mesh*);
+    // a whole new mesh was loaded in place of the old one, or the old one was subdivided and renumbered, so nothing
+    // the lists show is valid anymore
+    void sig_meshWasReplaced(const Mesh*);
 
 public slots:
-    void tick();
     void slot_splitEdge();
     void slot_triangulateFace();
     void slot_catmullClark();
+    void slot_loopSubdivision();
 };
 
 
@@ -0,0 +1,302 @@
+#include "objreader.h"
+#include "mappedfile.h"
+#include "parallel.h"
+#include "debug.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <limits>
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static const char* skipSpaces(const char* p, const char* end) {
+    while (p < end && isSpace(*p)) p++;
+    return p;
+}
+
+static const char* nextLine(const char* p, const char* end) {
+    const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    return nl ? nl + 1 : end;
+}
+
+// from_chars doesn't take a leading '+', which some exporters write
+static const char* parseFloat(const char* p, const char* end, float& val) {
+    p = skipSpaces(p, end);
+    if (p < end && *p == '+') p++;
+    return std::from_chars(p, end, val).ptr;
+}
+
+// parses one index of a face corner, returning nullptr if there is no number at p
+static const char* parseIndex(const char* p, const char* end, int& idx) {
+    auto [after, err] = std::from_chars(p, end, idx);
+    return err == std::errc() ? after : nullptr;
+}
+
+// Corners whose uv/normal index is only optional are stored lazily: the array stays empty until some corner
+// actually has one, then it is back-filled with -1 for the corners before it.
+// (a relative index can still be negative inside a chunk, so whether the corner has one is passed separately)
+static void pushCornerAttrib(std::vector<int>& cornerAttribs, Index corner, bool present, int value) {
+    if (cornerAttribs.empty()) {
+        if (!present) return;
+        cornerAttribs.assign(corner, -1);
+    }
+    cornerAttribs.push_back(present ? value : -1);
+}
+
+// the corners of a chunk holding negative (relative) indices, one list per kind of index
+struct RelativeCorners
+{
+    std::vector<Index> positions, uvs, normals;
+};
+
+/*
+Parses the v, vt, vn and f lines in [p, end), which must start at the beginning of a line.
+We only look at the first character(s) of each line to decide what it is, and numbers are read in place with from_chars,
+so nothing is copied into temporary strings. A face corner looks like "pos", "pos/uv", "pos//nor" or "pos/uv/nor".
+Negative indices are resolved against what is in `out` only, and the corners holding them are listed in
+`relative`, because when [p, end) is a chunk of a bigger file they still need the earlier chunks' counts added.
+*/
+static void parseOBJ(const char* p, const char* end, ObjData& out, RelativeCorners& relative) {
+    // 1-based, or negative to count back from the last element read so far
+    // (0 refers to nothing, so it becomes an index no file has, for readOBJ to drop the face)
+    auto resolve = [](int idx, std::size_t count, std::vector<Index>& relativeList, Index corner) {
+        if (idx == 0) return std::numeric_limits<int>::min();
+        if (idx > 0) return idx - 1;
+        relativeList.push_back(corner);
+        return int(count) + idx;
+    };
+
+    while (p < end) {
+        p = skipSpaces(p, end);
+        if (p + 1 < end && p[0] == 'v' && isSpace(p[1])) {
+            glm::vec3 pos(0.f);
+            const char* q = p + 1;
+            q = parseFloat(q, end, pos.x);
+            q = parseFloat(q, end, pos.y);
+            q = parseFloat(q, end, pos.z);
+            out.positions.push_back(pos);
+            p = nextLine(q, end);
+        }
+        else if (p + 2 < end && p[0] == 'v' && p[1] == 't' && isSpace(p[2])) {
+            glm::vec2 uv(0.f);
+            const char* q = p + 2;
+            q = parseFloat(q, end, uv.x);
+            q = parseFloat(q, end, uv.y);
+            out.uvs.push_back(uv);
+            p = nextLine(q, end);
+        }
+        else if (p + 2 < end && p[0] == 'v' && p[1] == 'n' && isSpace(p[2])) {
+            glm::vec3 nor(0.f);
+            const char* q = p + 2;
+            q = parseFloat(q, end, nor.x);
+            q = parseFloat(q, end, nor.y);
+            q = parseFloat(q, end, nor.z);
+            out.normals.push_back(nor);
+            p = nextLine(q, end);
+        }
+        else if (p + 1 < end && p[0] == 'f' && isSpace(p[1])) {
+            const char* q = p + 1;
+            const Index numCorners = out.faceCorners.size();
+            while (true) {
+                q = skipSpaces(q, end);
+                if (q >= end || *q == '\n' || *q == '#') break;
+                int idx = 0;
+                const char* after = parseIndex(q, end, idx);
+                if (!after) break;  // malformed corner, drop the rest of the line
+                const Index corner = out.faceCorners.size();
+                out.faceCorners.push_back(resolve(idx, out.positions.size(), relative.positions, corner));
+                q = after;
+
+                int uv = 0, nor = 0;
+                bool hasUV = false, hasNor = false;
+                if (q < end && *q == '/') {
+                    q++;
+                    if ((after = parseIndex(q, end, idx))) {
+                        uv = resolve(idx, out.uvs.size(), relative.uvs, corner);
+                        hasUV = true;
+                        q = after;
+                    }
+                    if (q < end && *q == '/') {
+                        q++;
+                        if ((after = parseIndex(q, end, idx))) {
+                            nor = resolve(idx, out.normals.size(), relative.normals, corner);
+                            hasNor = true;
+                            q = after;
+                        }
+                    }
+                }
+                pushCornerAttrib(out.cornerUVs, corner, hasUV, uv);
+                pushCornerAttrib(out.cornerNormals, corner, hasNor, nor);
+                while (q < end && !isSpace(*q) && *q != '\n') q++;  // skip anything else stuck to the corner
+            }
+            // a face needs at least three corners, anything less is dropped
+            if (out.faceCorners.size() - numCorners >= 3) {
+                out.faceStart.push_back(out.faceCorners.size());
+            } else {
+                out.faceCorners.resize(numCorners);
+                if (out.cornerUVs.size() > numCorners) out.cornerUVs.resize(numCorners);
+                if (out.cornerNormals.size() > numCorners) out.cornerNormals.resize(numCorners);
+                for (std::vector<Index>* list : {&relative.positions, &relative.uvs, &relative.normals}) {
+                    while (!list->empty() && list->back() >= numCorners) list->pop_back();
+                }
+            }
+            p = nextLine(q, end);
+        }
+        else {
+            p = nextLine(p, end);
+        }
+    }
+}
+
+// marks the corners whose relative indices, now resolved against everything before their chunk (which starts at
+// corner `cornerOffset`), still point before the first element of the file
+static void markRelativeBeforeStart(const ObjData& out, const RelativeCorners& relative, Index cornerOffset,
+                                    std::vector<char>& badCorner) {
+    for (Index corner : relative.positions) {
+        if (out.faceCorners[cornerOffset + corner] < 0) badCorner[cornerOffset + corner] = true;
+    }
+    for (Index corner : relative.uvs) {
+        if (out.cornerUVs[cornerOffset + corner] < 0) badCorner[cornerOffset + corner] = true;
+    }
+    for (Index corner : relative.normals) {
+        if (out.cornerNormals[cornerOffset + corner] < 0) badCorner[cornerOffset + corner] = true;
+    }
+}
+
+/*
+Drops every face with a corner marked in badCorner, or with an index past the end of the positions, uvs or normals
+read (-1 is a corner without a uv or normal). Only the whole file knows how many of each there are, so this runs after
+the chunks are merged. buildMesh can then trust every index it is given.
+*/
+static void dropInvalidFaces(ObjData& out, std::vector<char>& badCorner) {
+    auto inRange = [](int idx, std::size_t count) {return idx >= 0 && std::size_t(idx) < count;};
+    parallelFor(out.faceCorners.size(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; c++) {
+            bool bad = !inRange(out.faceCorners[c], out.positions.size());
+            if (!out.cornerUVs.empty() && out.cornerUVs[c] != -1) {
+                bad = bad || !inRange(out.cornerUVs[c], out.uvs.size());
+            }
+            if (!out.cornerNormals.empty() && out.cornerNormals[c] != -1) {
+                bad = bad || !inRange(out.cornerNormals[c], out.normals.size());
+            }
+            if (bad) badCorner[c] = true;
+        }
+    });
+
+    // compact the faces that are left, in place
+    Index numDropped = 0;
+    Index corner = 0;
+    Index face = 0;
+    for (Index f = 0; f < out.numFaces(); f++) {
+        const Index begin = out.faceStart[f], end = out.faceStart[f + 1];
+        if (std::find(badCorner.begin() + begin, badCorner.begin() + end, true) != badCorner.begin() + end) {
+            numDropped++;
+            continue;
+        }
+        for (Index c = begin; c < end; c++, corner++) {
+            out.faceCorners[corner] = out.faceCorners[c];
+            if (!out.cornerUVs.empty()) out.cornerUVs[corner] = out.cornerUVs[c];
+            if (!out.cornerNormals.empty()) out.cornerNormals[corner] = out.cornerNormals[c];
+        }
+        out.faceStart[++face] = corner;
+    }
+    if (numDropped == 0) return;
+    out.faceStart.resize(face + 1);
+    out.faceCorners.resize(corner);
+    if (!out.cornerUVs.empty()) out.cornerUVs.resize(corner);
+    if (!out.cornerNormals.empty()) out.cornerNormals.resize(corner);
+    LOG("dropped " << numDropped << " faces with an index past the vertices, uvs or normals of the file");
+}
+
+// below this many bytes per thread, splitting the file costs more than it saves
+static const std::size_t MIN_CHUNK_BYTES = 4 << 20;
+
+bool readOBJ(const std::string& path, ObjData& out) {
+    /*
+    The file is cut into one chunk per thread, each cut moved forward to just after a newline so no line is split.
+    Every chunk is parsed on its own thread into its own ObjData, then the chunks are appended in file order.
+    Positive indices are absolute, so only faceStart (and any relative indices) need offsetting while merging.
+    */
+    MappedFile file(path);
+    if (!file.isOpen()) return false;
+
+    const std::size_t size = file.end() - file.begin();
+    const std::size_t numChunks = std::max<std::size_t>(1, std::min<std::size_t>(threadCount(), size / MIN_CHUNK_BYTES));
+    std::vector<const char*> cuts(numChunks + 1, file.end());
+    cuts[0] = file.begin();
+    for (std::size_t c = 1; c < numChunks; c++) {
+        const char* cut = std::max(file.begin() + size * c / numChunks, cuts[c - 1]);
+        cuts[c] = nextLine(cut, file.end());
+    }
+
+    std::vector<ObjData> chunks(numChunks);
+    std::vector<RelativeCorners> relative(numChunks);
+    parallelFor(numChunks, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; c++) {
+            parseOBJ(cuts[c], cuts[c + 1], chunks[c], relative[c]);
+        }
+    }, 1);
+
+    if (numChunks == 1) {
+        out = std::move(chunks[0]);
+        std::vector<char> badCorner(out.faceCorners.size(), false);
+        markRelativeBeforeStart(out, relative[0], 0, badCorner);
+        dropInvalidFaces(out, badCorner);
+        return true;
+    }
+
+    // where each chunk's vertices, uvs, normals, corners and faces start in the merged arrays
+    std::vector<Index> vertOffset(numChunks + 1, 0), uvOffset(numChunks + 1, 0), norOffset(numChunks + 1, 0);
+    std::vector<Index> cornerOffset(numChunks + 1, 0), faceOffset(numChunks + 1, 0);
+    bool anyUVs = false, anyNormals = false;
+    for (std::size_t c = 0; c < numChunks; c++) {
+        vertOffset[c + 1] = vertOffset[c] + chunks[c].positions.size();
+        uvOffset[c + 1] = uvOffset[c] + chunks[c].uvs.size();
+        norOffset[c + 1] = norOffset[c] + chunks[c].normals.size();
+        cornerOffset[c + 1] = cornerOffset[c] + chunks[c].faceCorners.size();
+        faceOffset[c + 1] = faceOffset[c] + chunks[c].numFaces();
+        anyUVs = anyUVs || !chunks[c].cornerUVs.empty();
+        anyNormals = anyNormals || !chunks[c].cornerNormals.empty();
+    }
+
+    out = ObjData();
+    out.positions.resize(vertOffset[numChunks]);
+    out.uvs.resize(uvOffset[numChunks]);
+    out.normals.resize(norOffset[numChunks]);
+    out.faceCorners.resize(cornerOffset[numChunks]);
+    if (anyUVs) out.cornerUVs.assign(cornerOffset[numChunks], -1);
+    if (anyNormals) out.cornerNormals.assign(cornerOffset[numChunks], -1);
+    out.faceStart.resize(faceOffset[numChunks] + 1);
+    out.faceStart[faceOffset[numChunks]] = cornerOffset[numChunks];
+    std::vector<char> badCorner(cornerOffset[numChunks], false);
+    parallelFor(numChunks, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; c++) {
+            ObjData& chunk = chunks[c];
+            std::copy(chunk.positions.begin(), chunk.positions.end(), out.positions.begin() + vertOffset[c]);
+            std::copy(chunk.uvs.begin(), chunk.uvs.end(), out.uvs.begin() + uvOffset[c]);
+            std::copy(chunk.normals.begin(), chunk.normals.end(), out.normals.begin() + norOffset[c]);
+            std::copy(chunk.faceCorners.begin(), chunk.faceCorners.end(), out.faceCorners.begin() + cornerOffset[c]);
+            std::copy(chunk.cornerUVs.begin(), chunk.cornerUVs.end(), out.cornerUVs.begin() + cornerOffset[c]);
+            std::copy(chunk.cornerNormals.begin(), chunk.cornerNormals.end(), out.cornerNormals.begin() + cornerOffset[c]);
+            for (Index corner : relative[c].positions) {
+                out.faceCorners[cornerOffset[c] + corner] += vertOffset[c];
+            }
+            for (Index corner : relative[c].uvs) {
+                out.cornerUVs[cornerOffset[c] + corner] += uvOffset[c];
+            }
+            for (Index corner : relative[c].normals) {
+                out.cornerNormals[cornerOffset[c] + corner] += norOffset[c];
+            }
+            for (Index f = 0; f < chunk.numFaces(); f++) {
+                out.faceStart[faceOffset[c] + f] = cornerOffset[c] + chunk.faceStart[f];
+            }
+            markRelativeBeforeStart(out, relative[c], cornerOffset[c], badCorner);
+            // free each chunk as soon as it is merged to keep the peak lower
+            chunk = ObjData();
+        }
+    }, 1);
+    dropInvalidFaces(out, badCorner);
+    return true;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <meshcomponents.h>
+#include <string>
+#include <vector>
+
+// Everything buildMesh needs from an OBJ file, stored flat: face f's position indices (0-based)
+// are faceCorners[faceStart[f]] .. faceCorners[faceStart[f+1]-1]. faceStart always has one more entry than there are faces.
+struct ObjData
+{
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> uvs;      // vt lines
+    std::vector<glm::vec3> normals;  // vn lines
+    std::vector<int> faceCorners;
+    // the vt/vn index of each corner, lined up with faceCorners, or -1 for a corner without one.
+    // empty when no corner in the file has one
+    std::vector<int> cornerUVs;
+    std::vector<int> cornerNormals;
+    std::vector<Index> faceStart = {0};
+
+    Index numFaces() const {return faceStart.size() - 1;}
+};
+
+// Reads the v, vt, vn and f lines of an OBJ file into `out`. Returns false, leaving `out` alone, if the file could not
+// be opened or mapped (a directory, say); an empty file reads as an empty mesh.
+// Negative (relative) indices are resolved against the elements read so far; other line types are skipped.
+// A face with an index that points at no vertex, uv or normal of the file is dropped, with a warning.
+bool readOBJ(const std::string& path, ObjData& out);
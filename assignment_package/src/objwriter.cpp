@@ -0,0 +1,72 @@
+#include "objwriter.h"
+#include <charconv>
+#include <cstdio>
+
+// Builds the file text in a buffer with to_chars (shortest round-trip floats) and writes it out in large blocks
+class ObjWriteBuffer
+{
+private:
+    std::FILE* file;
+    std::vector<char> buf;
+    std::size_t used = 0;
+    bool ok = true;
+
+public:
+    ObjWriteBuffer(std::FILE* file) : file(file), buf(1 << 20) {}
+
+    void flush() {
+        if (used > 0 && std::fwrite(buf.data(), 1, used, file) != used) ok = false;
+        used = 0;
+    }
+    // every call writes far less than this, so one flush always makes room
+    void reserve() {
+        if (buf.size() - used < 256) flush();
+    }
+    void put(char c) {buf[used++] = c;}
+    void put(const char* s) {while (*s) buf[used++] = *s++;}
+    void put(float f) {used = std::to_chars(buf.data() + used, buf.data() + buf.size(), f).ptr - buf.data();}
+    void put(Index i) {used = std::to_chars(buf.data() + used, buf.data() + buf.size(), i).ptr - buf.data();}
+    bool good() const {return ok;}
+};
+
+bool writeOBJ(const std::string& path, const HalfEdgeMesh& mesh) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    ObjWriteBuffer out(file);
+
+    for (const glm::vec3& p : mesh.positions) {
+        out.reserve();
+        out.put("v "); out.put(p.x); out.put(' '); out.put(p.y); out.put(' '); out.put(p.z); out.put('\n');
+    }
+    // corners are written per half-edge, so half-edge he's uv/normal is line he+1 of its kind
+    for (const glm::vec2& uv : mesh.heUV) {
+        out.reserve();
+        out.put("vt "); out.put(uv.x); out.put(' '); out.put(uv.y); out.put('\n');
+    }
+    for (const glm::vec3& n : mesh.heNormal) {
+        out.reserve();
+        out.put("vn "); out.put(n.x); out.put(' '); out.put(n.y); out.put(' '); out.put(n.z); out.put('\n');
+    }
+
+    for (Index f = 0; f < mesh.numFaces(); f++) {
+        out.reserve();
+        out.put('f');
+        Index cur = mesh.faceEdge[f];
+        do {
+            out.reserve();
+            out.put(' ');
+            out.put(mesh.heVertex[cur] + 1);
+            if (mesh.hasUVs() || mesh.hasNormals()) {
+                out.put('/');
+                if (mesh.hasUVs()) out.put(cur + 1);
+                if (mesh.hasNormals()) {out.put('/'); out.put(cur + 1);}
+            }
+            cur = mesh.heNext[cur];
+        } while (cur != mesh.faceEdge[f]);
+        out.put('\n');
+    }
+
+    out.flush();
+    bool ok = std::fclose(file) == 0 && out.good();
+    return ok;
+}
@@ -0,0 +1,7 @@
+#pragma once
+#include <halfedgemesh.h>
+#include <string>
+
+// Writes the mesh as an OBJ file: one v line per vertex and one f line per face, plus one vt/vn line per half-edge
+// when the mesh has uvs/normals. Returns false if the file could not be written.
+bool writeOBJ(const std::string& path, const HalfEdgeMesh& mesh);
@@ -0,0 +1,12 @@
+#include "parallel.h"
+#include <algorithm>
+
+static unsigned numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+unsigned threadCount() {
+    return numThreads;
+}
+
+void setThreadCount(unsigned n) {
+    numThreads = std::max(1u, n);
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// How many threads the mesh operations may use. Defaults to one per core; 1 runs everything on the calling thread.
+unsigned threadCount();
+void setThreadCount(unsigned);
+
+// Calls f(begin, end) on contiguous chunks that together cover [0, n), one chunk per thread, and waits for all of them.
+// Ranges too small to be worth a thread (less than minChunk per thread) are split over fewer threads, down to just
+// the calling thread, so callers never need a separate serial path.
+template<class F>
+void parallelFor(std::size_t n, F&& f, std::size_t minChunk = 4096) {
+    std::size_t numChunks = std::min<std::size_t>(threadCount(), (n + minChunk - 1) / minChunk);
+    if (numChunks <= 1) {
+        if (n > 0) f(std::size_t(0), n);
+        return;
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(numChunks - 1);
+    for (std::size_t c = 1; c < numChunks; c++) {
+        workers.emplace_back([&f, c, n, numChunks]() {f(n * c / numChunks, n * (c + 1) / numChunks);});
+    }
+    f(std::size_t(0), n / numChunks);  // the calling thread takes the first chunk
+    for (std::thread& t : workers) t.join();
+}
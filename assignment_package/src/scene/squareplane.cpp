@@ -11,20 +11,10 @@ SquarePlane::~SquarePlane()
 void SquarePlane::initializeAndBufferGeometryData()
 {
 
-    std::vector<glm::vec3> pos {glm::vec3(-2, -2, 0),
-                                glm::vec3(2, -2, 0),
-                                glm::vec3(2, 2, 0),
-                                glm::vec3(-2, 2, 0)};
-
-    std::vector<glm::vec3> nor {glm::vec3(0, 0, 1),
-                                glm::vec3(0, 0, 1),
-                                glm::vec3(0, 0, 1),
-                                glm::vec3(0, 0, 1)};
-
-    std::vector<glm::vec3> col {glm::vec3(1, 0, 0),
-                                glm::vec3(0, 1, 0),
-                                glm::vec3(0, 0, 1),
-                                glm::vec3(1, 1, 0)};
+    std::vector<GLVertex> verts {{glm::vec3(-2, -2, 0), glm::vec3(0, 0, 1), glm::vec3(1, 0, 0)},
+                                 {glm::vec3(2, -2, 0), glm::vec3(0, 0, 1), glm::vec3(0, 1, 0)},
+                                 {glm::vec3(2, 2, 0), glm::vec3(0, 0, 1), glm::vec3(0, 0, 1)},
+                                 {glm::vec3(-2, 2, 0), glm::vec3(0, 0, 1), glm::vec3(1, 1, 0)}};
 
     std::vector<GLuint> idx {0, 1, 2, 0, 2, 3};
 
@@ -34,16 +24,8 @@ void SquarePlane::initializeAndBufferGeometryData()
     bindBuffer(INDEX);
     bufferData(INDEX, idx);
 
-    generateBuffer(POSITION);
-    bindBuffer(POSITION);
-    bufferData(POSITION, pos);
-
-    generateBuffer(NORMAL);
-    bindBuffer(NORMAL);
-    bufferData(NORMAL, nor);
-
-    generateBuffer(COLOR);
-    bindBuffer(COLOR);
-    bufferData(COLOR, col);
+    generateBuffer(VERTEX);
+    bindBuffer(VERTEX);
+    bufferData(VERTEX, verts);
 
 }
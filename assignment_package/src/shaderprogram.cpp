@@ -8,38 +8,9 @@ ShaderProgram::ShaderProgram(OpenGLContext *context)
 
 void ShaderProgram::draw(Drawable &d) {
     useProgram();
-    if(isAttribHandleValid("vs_Pos")) {
-        d.bindBuffer(POSITION);
-        glContext->glEnableVertexAttribArray(getAttribHandle("vs_Pos"));
-        glContext->glVertexAttribPointer(getAttribHandle("vs_Pos"), 3, GL_FLOAT, false, 0, nullptr);
-    }
-    printGLErrorLog();
-    if(isAttribHandleValid("vs_Nor")) {
-        d.bindBuffer(NORMAL);
-        glContext->glEnableVertexAttribArray(getAttribHandle("vs_Nor"));
-        glContext->glVertexAttribPointer(getAttribHandle("vs_Nor"), 3, GL_FLOAT, false, 0, nullptr);
-    }
-    printGLErrorLog();
-    if(isAttribHandleValid("vs_Col")) {
-        d.bindBuffer(COLOR);
-        glContext->glEnableVertexAttribArray(getAttribHandle("vs_Col"));
-        glContext->glVertexAttribPointer(getAttribHandle("vs_Col"), 3, GL_FLOAT, false, 0, nullptr);
-    }
-
-    printGLErrorLog();
-    d.bindBuffer(INDEX);
+    // the Drawable's VAO already has its buffers and where every attribute sits in them
+    d.bindVertexArray();
     glContext->glDrawElements(d.drawMode(), d.getIndexBufferLength(), GL_UNSIGNED_INT, 0);
-
-    printGLErrorLog();
-    if(isAttribHandleValid("vs_Pos")) {
-        glContext->glDisableVertexAttribArray(getAttribHandle("vs_Pos"));
-    }
-    if(isAttribHandleValid("vs_Nor")) {
-        glContext->glDisableVertexAttribArray(getAttribHandle("vs_Nor"));
-    }
-    if(isAttribHandleValid("vs_Col")) {
-        glContext->glDisableVertexAttribArray(getAttribHandle("vs_Col"));
-    }
     printGLErrorLog();
 }
 
@@ -119,6 +90,10 @@ void ShaderProgram::createAndCompileShaderProgram(QString vertFile,
     // these particular vertex and fragment shaders
     glContext->glAttachShader(shaderProgram, vertShader);
     glContext->glAttachShader(shaderProgram, fragShader);
+    // every shader reads its attributes from the same locations, the ones Drawable's VAOs are set up with
+    glContext->glBindAttribLocation(shaderProgram, ATTRIB_POS, "vs_Pos");
+    glContext->glBindAttribLocation(shaderProgram, ATTRIB_NOR, "vs_Nor");
+    glContext->glBindAttribLocation(shaderProgram, ATTRIB_COL, "vs_Col");
     glContext->glLinkProgram(shaderProgram);
 
     // Check for linking success
@@ -128,6 +103,12 @@ void ShaderProgram::createAndCompileShaderProgram(QString vertFile,
         printLinkInfoLog(shaderProgram);
     }
 
+    // read the camera from the one uniform buffer MyGL keeps at CAMERA_BLOCK_BINDING
+    GLuint cameraBlock = glContext->glGetUniformBlockIndex(shaderProgram, "Camera");
+    if (cameraBlock != GL_INVALID_INDEX) {
+        glContext->glUniformBlockBinding(shaderProgram, cameraBlock, CAMERA_BLOCK_BINDING);
+    }
+
     parseShaderSourceForVariables(vertexShaderSource, fragmentShaderSource);
     // Manually de-allocate the heap memory used to store the
     // shader contents. We don't need it now that it's been sent
@@ -205,7 +186,7 @@ void ShaderProgram::addAttrib(std::string name) {
     shaderAttribVariableHandles[name] = glContext->glGetAttribLocation(shaderProgram, name.c_str());
 }
 
-GLuint ShaderProgram::getUniformHandle(std::string name) const {
+GLint ShaderProgram::getUniformHandle(const std::string& name) const {
     try {
         return shaderUniformVariableHandles.at(name);
     } catch(std::exception &e) {
@@ -213,7 +194,7 @@ GLuint ShaderProgram::getUniformHandle(std::string name) const {
         return -1;
     }
 }
-GLuint ShaderProgram::getAttribHandle(std::string name) const {
+GLint ShaderProgram::getAttribHandle(const std::string& name) const {
     try {
         return shaderAttribVariableHandles.at(name);
     } catch(std::exception &e) {
@@ -222,7 +203,7 @@ GLuint ShaderProgram::getAttribHandle(std::string name) const {
     }
 }
 
-bool ShaderProgram::isUniformHandleValid(std::string name) const {
+bool ShaderProgram::isUniformHandleValid(const std::string& name) const {
     try {
         return shaderUniformVariableHandles.at(name) != -1;
     } catch(std::exception &e) {
@@ -230,7 +211,7 @@ bool ShaderProgram::isUniformHandleValid(std::string name) const {
     }
 }
 
-bool ShaderProgram::isAttribHandleValid(std::string name) const {
+bool ShaderProgram::isAttribHandleValid(const std::string& name) const {
     try {
         return shaderAttribVariableHandles.at(name) != -1;
     } catch(std::exception &e) {
@@ -238,53 +219,91 @@ bool ShaderProgram::isAttribHandleValid(std::string name) const {
     }
 }
 
-void ShaderProgram::setUnifInt(std::string name, int val) {
+void ShaderProgram::setUnifInt(const std::string& name, int val) {
+    setUnifInt(getUniformHandle(name), val);
+}
+void ShaderProgram::setUnifFloat(const std::string& name, float val) {
+    setUnifFloat(getUniformHandle(name), val);
+}
+
+void ShaderProgram::setUnifVec2(const std::string& name, const glm::vec2& val) {
+    setUnifVec2(getUniformHandle(name), val);
+}
+void ShaderProgram::setUnifVec3(const std::string& name, const glm::vec3& val) {
+    setUnifVec3(getUniformHandle(name), val);
+}
+void ShaderProgram::setUnifVec4(const std::string& name, const glm::vec4& val) {
+    setUnifVec4(getUniformHandle(name), val);
+}
+
+void ShaderProgram::setUnifIVec2(const std::string& name, const glm::ivec2& val) {
+    setUnifIVec2(getUniformHandle(name), val);
+}
+void ShaderProgram::setUnifIVec3(const std::string& name, const glm::ivec3& val) {
+    setUnifIVec3(getUniformHandle(name), val);
+}
+void ShaderProgram::setUnifIVec4(const std::string& name, const glm::ivec4& val) {
+    setUnifIVec4(getUniformHandle(name), val);
+}
+
+void ShaderProgram::setUnifMat2(const std::string& name, const glm::mat2& val) {
+    setUnifMat2(getUniformHandle(name), val);
+}
+void ShaderProgram::setUnifMat3(const std::string& name, const glm::mat3& val) {
+    setUnifMat3(getUniformHandle(name), val);
+}
+void ShaderProgram::setUnifMat4(const std::string& name, const glm::mat4& val) {
+    setUnifMat4(getUniformHandle(name), val);
+}
+
+void ShaderProgram::setUnifInt(GLint location, int val) {
     useProgram();
-    glContext->glUniform1i(getUniformHandle(name), val);
+    glContext->glUniform1i(location, val);
 }
-void ShaderProgram::setUnifFloat(std::string name, float val) {
+void ShaderProgram::setUnifFloat(GLint location, float val) {
     useProgram();
-    glContext->glUniform1f(getUniformHandle(name), val);
+    glContext->glUniform1f(location, val);
 }
-void ShaderProgram::setUnifVec2(std::string name, glm::vec2 val) {
+
+void ShaderProgram::setUnifVec2(GLint location, const glm::vec2& val) {
     useProgram();
-    glContext->glUniform2fv(getUniformHandle(name), 1, &val[0]);
+    glContext->glUniform2fv(location, 1, &val[0]);
 }
-void ShaderProgram::setUnifVec3(std::string name, glm::vec3 val) {
+void ShaderProgram::setUnifVec3(GLint location, const glm::vec3& val) {
     useProgram();
-    glContext->glUniform3fv(getUniformHandle(name), 1, &val[0]);
+    glContext->glUniform3fv(location, 1, &val[0]);
 }
-void ShaderProgram::setUnifVec4(std::string name, glm::vec4 val) {
+void ShaderProgram::setUnifVec4(GLint location, const glm::vec4& val) {
     useProgram();
-    glContext->glUniform4fv(getUniformHandle(name), 1, &val[0]);
+    glContext->glUniform4fv(location, 1, &val[0]);
 }
 
-void ShaderProgram::setUnifIVec2(std::string name, glm::ivec2 val) {
+void ShaderProgram::setUnifIVec2(GLint location, const glm::ivec2& val) {
     useProgram();
-    glContext->glUniform2iv(getUniformHandle(name), 1, &val[0]);
+    glContext->glUniform2iv(location, 1, &val[0]);
 }
-void ShaderProgram::setUnifIVec3(std::string name, glm::ivec3 val) {
+void ShaderProgram::setUnifIVec3(GLint location, const glm::ivec3& val) {
     useProgram();
-    glContext->glUniform3iv(getUniformHandle(name), 1, &val[0]);
+    glContext->glUniform3iv(location, 1, &val[0]);
 }
-void ShaderProgram::setUnifIVec4(std::string name, glm::ivec4 val) {
+void ShaderProgram::setUnifIVec4(GLint location, const glm::ivec4& val) {
     useProgram();
-    glContext->glUniform4iv(getUniformHandle(name), 1, &val[0]);
+    glContext->glUniform4iv(location, 1, &val[0]);
 }
 
-void ShaderProgram::setUnifMat2(std::string name, glm::mat2 val) {
+void ShaderProgram::setUnifMat2(GLint location, const glm::mat2& val) {
     useProgram();
-    glContext->glUniformMatrix2fv(getUniformHandle(name), 1,
+    glContext->glUniformMatrix2fv(location, 1,
                                   GL_FALSE, &val[0][0]);
 }
-void ShaderProgram::setUnifMat3(std::string name, glm::mat3 val) {
+void ShaderProgram::setUnifMat3(GLint location, const glm::mat3& val) {
     useProgram();
-    glContext->glUniformMatrix3fv(getUniformHandle(name), 1,
+    glContext->glUniformMatrix3fv(location, 1,
                                   GL_FALSE, &val[0][0]);
 }
-void ShaderProgram::setUnifMat4(std::string name, glm::mat4 val) {
+void ShaderProgram::setUnifMat4(GLint location, const glm::mat4& val) {
     useProgram();
-    glContext->glUniformMatrix4fv(getUniformHandle(name), 1,
+    glContext->glUniformMatrix4fv(location, 1,
                                   GL_FALSE, &val[0][0]);
 }
 
@@ -3,6 +3,17 @@
 #include "drawable.h"
 #include <la.h>
 
+// The per-frame camera data, laid out as the std140 `Camera`
+// uniform block the shaders declare. MyGL writes it to one
+// uniform buffer that every ShaderProgram reads, instead of
+// setting u_ViewProj and u_CamPos on each program.
+struct CameraBlock {
+    glm::mat4 viewProj;
+    glm::vec4 camPos;   // xyz; std140 pads a vec3 to 16 bytes anyway
+};
+// the binding point the Camera block of every shader is linked to
+const GLuint CAMERA_BLOCK_BINDING = 0;
+
 class ShaderProgram {
 private:
     // See MyGL's `glContext` member for more info
@@ -52,7 +63,8 @@ public:
 
     // Make all of the relevant OpenGL API calls
     // to draw the data stored in the vertex buffer objects
-    // associated with the given Drawable.
+    // associated with the given Drawable: binding its VAO
+    // and one glDrawElements.
     void draw(Drawable &d);
 
     // Calls glUseProgram in a public context
@@ -64,31 +76,52 @@ public:
     void addUniform(std::string name);
     void addAttrib(std::string name);
 
-    void setUnifInt(std::string name, int val);
-    void setUnifFloat(std::string name, float val);
+    // Set a uniform by name. Each call looks the name up in
+    // shaderUniformVariableHandles, so anything set every frame
+    // should use the location overloads below instead.
+    void setUnifInt(const std::string& name, int val);
+    void setUnifFloat(const std::string& name, float val);
+
+    void setUnifVec2(const std::string& name, const glm::vec2& val);
+    void setUnifVec3(const std::string& name, const glm::vec3& val);
+    void setUnifVec4(const std::string& name, const glm::vec4& val);
+
+    void setUnifIVec2(const std::string& name, const glm::ivec2& val);
+    void setUnifIVec3(const std::string& name, const glm::ivec3& val);
+    void setUnifIVec4(const std::string& name, const glm::ivec4& val);
+
+    void setUnifMat2(const std::string& name, const glm::mat2& val);
+    void setUnifMat3(const std::string& name, const glm::mat3& val);
+    void setUnifMat4(const std::string& name, const glm::mat4& val);
+
+    // Set a uniform by the location getUniformHandle returned
+    // for it, resolved once after createAndCompileShaderProgram.
+    // A location of -1 (no such uniform) is ignored by OpenGL.
+    void setUnifInt(GLint location, int val);
+    void setUnifFloat(GLint location, float val);
 
-    void setUnifVec2(std::string name, glm::vec2 val);
-    void setUnifVec3(std::string name, glm::vec3 val);
-    void setUnifVec4(std::string name, glm::vec4 val);
+    void setUnifVec2(GLint location, const glm::vec2& val);
+    void setUnifVec3(GLint location, const glm::vec3& val);
+    void setUnifVec4(GLint location, const glm::vec4& val);
 
-    void setUnifIVec2(std::string name, glm::ivec2 val);
-    void setUnifIVec3(std::string name, glm::ivec3 val);
-    void setUnifIVec4(std::string name, glm::ivec4 val);
+    void setUnifIVec2(GLint location, const glm::ivec2& val);
+    void setUnifIVec3(GLint location, const glm::ivec3& val);
+    void setUnifIVec4(GLint location, const glm::ivec4& val);
 
-    void setUnifMat2(std::string name, glm::mat2 val);
-    void setUnifMat3(std::string name, glm::mat3 val);
-    void setUnifMat4(std::string name, glm::mat4 val);
+    void setUnifMat2(GLint location, const glm::mat2& val);
+    void setUnifMat3(GLint location, const glm::mat3& val);
+    void setUnifMat4(GLint location, const glm::mat4& val);
 
     // Used to access the handles for `uniform` and `in`
     // variables stored in the unordered_maps in this class.
     // Call these from MyGL whenever you need to get shader
     // variable handles.
-    GLuint getUniformHandle(std::string name) const;
-    GLuint getAttribHandle(std::string name) const;
+    GLint getUniformHandle(const std::string& name) const;
+    GLint getAttribHandle(const std::string& name) const;
 
     // Tells you if this shader program has a valid handle
     // for a given variable name.
-    bool isUniformHandleValid(std::string name) const;
-    bool isAttribHandleValid(std::string name) const;
+    bool isUniformHandleValid(const std::string& name) const;
+    bool isAttribHandleValid(const std::string& name) const;
 
 };
@@ -1,12 +1,15 @@
 INCLUDEPATH += $$PWD
 DEPENDPATH += $$PWD
 
+# the mesh kernel and file formats, shared with the command-line tool
+include(core.pri)
+
 SOURCES += \
     $$PWD/main.cpp \
     $$PWD/mainwindow.cpp \
     $$PWD/mesh.cpp \
     $$PWD/meshcomponentdisplays.cpp \
-    $$PWD/meshcomponents.cpp \
+    $$PWD/meshlistmodel.cpp \
     $$PWD/mygl.cpp \
     $$PWD/shaderprogram.cpp \
     $$PWD/utils.cpp \
@@ -17,12 +20,11 @@ SOURCES += \
     $$PWD/scene/squareplane.cpp
 
 HEADERS += \
-    $$PWD/debug.h \
     $$PWD/la.h \
     $$PWD/mainwindow.h \
     $$PWD/mesh.h \
     $$PWD/meshcomponentdisplays.h \
-    $$PWD/meshcomponents.h \
+    $$PWD/meshlistmodel.h \
     $$PWD/mygl.h \
     $$PWD/shaderprogram.h \
     $$PWD/utils.h \
@@ -0,0 +1,300 @@
+#include "stenciltable.h"
+#include "parallel.h"
+#include "subdivisionrules.h"
+#include <algorithm>
+#include <cmath>
+
+void StencilTable::clear() {
+    stencilStart = {0};
+    sources.clear();
+    weights.clear();
+    dependentStart.clear();
+    dependents.clear();
+}
+
+void StencilTable::buildDependents(Index numCage) {
+    // counting sort of the (stencil, source) pairs by source. stencils stay in order within each source
+    dependentStart.assign(numCage + 1, 0);
+    for (Index s : sources) dependentStart[s + 1]++;
+    for (Index v = 0; v < numCage; v++) dependentStart[v + 1] += dependentStart[v];
+    dependents.resize(sources.size());
+    std::vector<Index> next(dependentStart.begin(), dependentStart.end() - 1);
+    for (Index i = 0; i < numStencils(); i++) {
+        for (Index j = stencilStart[i]; j < stencilStart[i + 1]; j++) {
+            dependents[next[sources[j]]++] = i;
+        }
+    }
+}
+
+glm::vec3 StencilTable::evaluate(const std::vector<glm::vec3>& cage, Index i) const {
+    glm::vec3 sum(0.f);
+    for (Index j = stencilStart[i]; j < stencilStart[i + 1]; j++) {
+        sum += weights[j] * cage[sources[j]];
+    }
+    return sum;
+}
+
+void StencilTable::apply(const std::vector<glm::vec3>& cage, std::vector<glm::vec3>& refined) const {
+    parallelFor(numStencils(), [&](std::size_t begin, std::size_t end) {
+        for (Index i = begin; i < end; i++) {
+            refined[i] = evaluate(cage, i);
+        }
+    }, 1024);
+}
+
+void StencilTable::applyRows(const std::vector<glm::vec3>& cage, std::vector<glm::vec3>& refined,
+                             const std::vector<Index>& rows) const {
+    parallelFor(rows.size(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t r = begin; r < end; r++) {
+            refined[rows[r]] = evaluate(cage, rows[r]);
+        }
+    }, 1024);
+}
+
+// Adds up weighted stencils into a single one. Terms on the same cage vertex are merged through a dense row,
+// and only the entries actually touched are visited again when the stencil is written out
+class StencilAccumulator
+{
+private:
+    std::vector<float> dense;        // one weight per cage vertex
+    std::vector<bool> inUse;
+    std::vector<Index> touched;
+
+public:
+    StencilAccumulator(Index numCage) : dense(numCage, 0.f), inUse(numCage, false) {}
+
+    // adds w * (cage vertex s)
+    void addSource(Index s, float w) {
+        if (!inUse[s]) {
+            inUse[s] = true;
+            touched.push_back(s);
+        }
+        dense[s] += w;
+    }
+    // adds w * (row of t)
+    void add(const StencilTable& t, Index row, float w) {
+        for (Index j = t.stencilStart[row]; j < t.stencilStart[row + 1]; j++) {
+            addSource(t.sources[j], w * t.weights[j]);
+        }
+    }
+
+    // appends the sum as a new row of out, and starts over
+    void finishRow(StencilTable& out) {
+        // sorted sources keep the table the same from run to run and make apply() read the cage in order
+        std::sort(touched.begin(), touched.end());
+        for (Index s : touched) {
+            out.sources.push_back(s);
+            out.weights.push_back(dense[s]);
+            dense[s] = 0.f;
+            inUse[s] = false;
+        }
+        touched.clear();
+        out.stencilStart.push_back(out.sources.size());
+    }
+};
+
+// appends all rows of `rows` to `out`
+static void appendRows(StencilTable& out, const StencilTable& rows) {
+    const Index base = out.sources.size();
+    out.sources.insert(out.sources.end(), rows.sources.begin(), rows.sources.end());
+    out.weights.insert(out.weights.end(), rows.weights.begin(), rows.weights.end());
+    for (Index i = 1; i < rows.stencilStart.size(); i++) {
+        out.stencilStart.push_back(base + rows.stencilStart[i]);
+    }
+}
+
+// Builds numRows stencils into out, calling addTerms(row, accumulator) for each. Rows are built in blocks on all
+// threads, then the blocks are joined in order
+template<class F>
+static void buildRows(Index numRows, Index numCage, StencilTable& out, F&& addTerms) {
+    const Index BLOCK = 4096;
+    const Index numBlocks = (numRows + BLOCK - 1) / BLOCK;
+    std::vector<StencilTable> blocks(numBlocks);
+    parallelFor(numBlocks, [&](std::size_t begin, std::size_t end) {
+        StencilAccumulator acc(numCage);
+        for (Index b = begin; b < end; b++) {
+            for (Index row = b * BLOCK; row < std::min(numRows, (b + 1) * BLOCK); row++) {
+                addTerms(row, acc);
+                acc.finishRow(blocks[b]);
+            }
+        }
+    }, 1);
+    out.clear();
+    for (const StencilTable& block : blocks) appendRows(out, block);
+}
+
+void subdivideStencils(const HalfEdgeMesh& m, const std::vector<bool>& refineFace, Index numCage, StencilTable& prev) {
+    /*
+    In the same order catmullClarkSelected adds vertices: old vertices keep their index, then come the centroids of the
+    refined faces, then the midpoints of the split edges.
+    The weights are the ones catmullClark uses, from subdivisionrules.h: a centroid is 1/n of each of the n face vertices,
+    and midpoints and old vertices are sums of old vertices and centroids, with creases and boundaries taken into account.
+    Each is expressed straight in cage vertices by adding up the stencils it refers to. A centroid that isn't added
+    (its face isn't refined) is expanded into the face vertices instead.
+    */
+    const std::vector<Index> edgeHalf = m.edgeHalfEdges();
+
+    // which row of centroids each refined face gets, NO_INDEX for the others
+    std::vector<Index> centroidRow(m.numFaces(), NO_INDEX);
+    std::vector<Index> refinedFaces;
+    for (Index f = 0; f < m.numFaces(); f++) {
+        if (!refineFace[f]) continue;
+        centroidRow[f] = refinedFaces.size();
+        refinedFaces.push_back(f);
+    }
+    std::vector<Index> splitEdges;
+    for (Index he : edgeHalf) {
+        if (refineFace[m.heFace[he]] || (!m.isBoundary(he) && refineFace[m.heFace[m.heSym[he]]])) splitEdges.push_back(he);
+    }
+    // a vertex is smoothed if it is on a refined face
+    std::vector<bool> smooth(m.numVertices(), false);
+    for (Index f : refinedFaces) {
+        Index cur = m.faceEdge[f];
+        do {smooth[m.heVertex[cur]] = true; cur = m.heNext[cur];} while (cur != m.faceEdge[f]);
+    }
+
+    StencilTable centroids, midpoints, next;
+    auto addFaceCorners = [&](Index f, float w, StencilAccumulator& acc) {
+        w /= m.faceDegree(f);
+        Index cur = m.faceEdge[f];
+        do {
+            acc.add(prev, m.heVertex[cur], w);
+            cur = m.heNext[cur];
+        } while (cur != m.faceEdge[f]);
+    };
+    auto addCentroid = [&](Index f, float w, StencilAccumulator& acc) {
+        if (centroidRow[f] != NO_INDEX) acc.add(centroids, centroidRow[f], w);
+        else addFaceCorners(f, w, acc);
+    };
+
+    buildRows(refinedFaces.size(), numCage, centroids, [&](Index row, StencilAccumulator& acc) {
+        addFaceCorners(refinedFaces[row], 1.f, acc);
+    });
+    buildRows(splitEdges.size(), numCage, midpoints, [&](Index row, StencilAccumulator& acc) {
+        catmullClarkEdgePoint(m, splitEdges[row], [&](Index u, float w) {acc.add(prev, u, w);},
+                                                  [&](Index f, float w) {addCentroid(f, w, acc);});
+    });
+    buildRows(m.numVertices(), numCage, next, [&](Index v, StencilAccumulator& acc) {
+        if (!smooth[v]) {  // not on a refined face (or on no face at all), it stays where it is
+            acc.add(prev, v, 1.f);
+            return;
+        }
+        catmullClarkVertexPoint(m, v, [&](Index u, float w) {acc.add(prev, u, w);},
+                                      [&](Index f, float w) {addCentroid(f, w, acc);});
+    });
+    appendRows(next, centroids);
+    appendRows(next, midpoints);
+    prev = std::move(next);
+}
+
+void StencilTable::setIdentity(Index n) {
+    clear();
+    for (Index v = 0; v < n; v++) {
+        sources.push_back(v);
+        weights.push_back(1.f);
+        stencilStart.push_back(v + 1);
+    }
+}
+
+void buildSubdivisionStencils(const HalfEdgeMesh& cage, int levels, HalfEdgeMesh& refined, StencilTable& stencils) {
+    refined = cage;
+    const Index numCage = cage.numVertices();
+
+    // level 0: every vertex is just itself. then one level at a time, every face refined
+    stencils.setIdentity(numCage);
+    for (int level = 0; level < levels; level++) {
+        addSubdivisionLevel(numCage, refined, stencils);
+    }
+    stencils.buildDependents(numCage);
+}
+
+void addSubdivisionLevel(Index numCage, HalfEdgeMesh& refined, StencilTable& stencils) {
+    subdivideStencils(refined, std::vector<bool>(refined.numFaces(), true), numCage, stencils);
+    refined.catmullClark();
+}
+
+void composeStencils(const StencilTable& outer, const StencilTable& inner, Index numCage, StencilTable& out) {
+    buildRows(outer.numStencils(), numCage, out, [&](Index row, StencilAccumulator& acc) {
+        for (Index j = outer.stencilStart[row]; j < outer.stencilStart[row + 1]; j++) {
+            acc.add(inner, outer.sources[j], outer.weights[j]);
+        }
+    });
+}
+
+bool buildLimitStencils(const HalfEdgeMesh& m, StencilTable& position, StencilTable& tangentU, StencilTable& tangentV) {
+    /*
+    The Catmull-Clark limit masks (Halstead, Kass and DeRose) are for a vertex whose faces are all quads. Every vertex is
+    like that one subdivision in: the ring of vertex v is then its new position v', the midpoints E_j of its n edges, and
+    the centroids F_j of its n faces. There
+        position  (n^2 v' + 4 sum E_j + sum F_j) / (n (n+5))
+        tangents  sum A cos(a_j) E_j + (cos(a_j) + cos(a_j+1)) F_j, and the same with sin,
+                  where a_j = 2 pi j / n and A = 1 + cos(2 pi/n) + cos(pi/n) sqrt(2 (9 + cos(2 pi/n)))
+    with F_j between E_j and E_j+1. v', E_j and F_j are all sums of m's own vertices, so each mask becomes a stencil over
+    them. The ring is walked the way vertexEdge and heSym go, which is clockwise seen from outside, so the angles run
+    backwards to keep tangentU x tangentV pointing out of the surface.
+    */
+    position.clear();
+    tangentU.clear();
+    tangentV.clear();
+    if (std::find(m.heSym.begin(), m.heSym.end(), NO_INDEX) != m.heSym.end() || m.hasCreases()) return false;
+
+    const float PI = 3.14159265358979f;
+    auto valence = [&](Index v) {
+        int n = 0;
+        Index cur = m.vertexEdge[v];
+        do {n++; cur = m.heSym[m.heNext[cur]];} while (cur != m.vertexEdge[v]);
+        return n;
+    };
+    auto addCentroid = [&](Index f, float w, StencilAccumulator& acc) {
+        w /= m.faceDegree(f);
+        Index cur = m.faceEdge[f];
+        do {
+            acc.addSource(m.heVertex[cur], w);
+            cur = m.heNext[cur];
+        } while (cur != m.faceEdge[f]);
+    };
+    // the smoothed midpoint of he's edge
+    auto addMidpoint = [&](Index he, float w, StencilAccumulator& acc) {
+        Index sym = m.heSym[he];
+        acc.addSource(m.heVertex[he], 0.25f * w);
+        acc.addSource(m.heVertex[sym], 0.25f * w);
+        addCentroid(m.heFace[he], 0.25f * w, acc);
+        addCentroid(m.heFace[sym], 0.25f * w, acc);
+    };
+    // wV v' + sum of wE(j) E_j + wF(j) F_j, with v' = (n-2)/n v + 1/n^2 (sum of neighbours) + 1/n^2 (sum of F_j)
+    auto addRing = [&](Index v, int n, float wV, auto wE, auto wF, StencilAccumulator& acc) {
+        float frac = 1.f / n;
+        acc.addSource(v, wV * frac * (n - 2));
+        Index cur = m.vertexEdge[v];
+        for (int j = 0; j < n; j++) {
+            acc.addSource(m.heVertex[m.heSym[cur]], wV * frac * frac);
+            addCentroid(m.heFace[cur], wV * frac * frac + wF(j), acc);
+            addMidpoint(cur, wE(j), acc);
+            cur = m.heSym[m.heNext[cur]];
+        }
+    };
+
+    const Index numVerts = m.numVertices();
+    buildRows(numVerts, numVerts, position, [&](Index v, StencilAccumulator& acc) {
+        if (m.vertexEdge[v] == NO_INDEX) {  // on no face, so it is its own limit
+            acc.addSource(v, 1.f);
+            return;
+        }
+        int n = valence(v);
+        float w = 1.f / (n * (n + 5));
+        addRing(v, n, n * n * w, [w](int) {return 4.f * w;}, [w](int) {return w;}, acc);
+    });
+    auto buildTangent = [&](StencilTable& out, float (*wave)(float)) {
+        buildRows(numVerts, numVerts, out, [&](Index v, StencilAccumulator& acc) {
+            if (m.vertexEdge[v] == NO_INDEX) return;
+            int n = valence(v);
+            float a = -2.f * PI / n;
+            float A = 1.f + std::cos(2.f * PI / n) + std::cos(PI / n) * std::sqrt(2.f * (9.f + std::cos(2.f * PI / n)));
+            addRing(v, n, 0.f, [&](int j) {return A * wave(a * j);},
+                               [&](int j) {return wave(a * j) + wave(a * (j + 1));}, acc);
+        });
+    };
+    buildTangent(tangentU, [](float x) {return std::cos(x);});
+    buildTangent(tangentV, [](float x) {return std::sin(x);});
+    return true;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <halfedgemesh.h>
+#include <vector>
+
+/*
+Subdivision is linear in the cage positions, so every vertex of a subdivided mesh is a fixed weighted sum of
+cage vertices. A StencilTable stores those sums, one row (stencil) per refined vertex, in compressed rows:
+refined vertex i is  sum of weights[j] * cage[sources[j]]  for j in [stencilStart[i], stencilStart[i+1]).
+Once built for a cage's topology, moving cage vertices only needs apply(), not another subdivision.
+*/
+class StencilTable
+{
+public:
+    std::vector<Index> stencilStart = {0};
+    std::vector<Index> sources;
+    std::vector<float> weights;
+
+    // the other way around: the stencils that use cage vertex v are dependents[dependentStart[v]] .. [dependentStart[v+1]-1]
+    std::vector<Index> dependentStart;
+    std::vector<Index> dependents;
+
+    Index numStencils() const {return stencilStart.size() - 1;}
+    void clear();
+    // n rows, each just that vertex
+    void setIdentity(Index n);
+    // fills dependentStart/dependents from the rows
+    void buildDependents(Index numCage);
+
+    // stencil i applied to cage
+    glm::vec3 evaluate(const std::vector<glm::vec3>& cage, Index i) const;
+    // refined[i] = stencil i applied to cage, for every stencil. refined must already have numStencils() entries
+    void apply(const std::vector<glm::vec3>& cage, std::vector<glm::vec3>& refined) const;
+    // same, for just the listed stencils
+    void applyRows(const std::vector<glm::vec3>& cage, std::vector<glm::vec3>& refined, const std::vector<Index>& rows) const;
+};
+
+// Subdivides a copy of `cage` `levels` times with catmullClark into `refined`, and fills `stencils` with one row per
+// refined vertex so that stencils.apply(cage.positions, refined.positions) reproduces the subdivided positions.
+// The dependents are filled in too, so a change to a few cage vertices can be traced to the refined vertices it moves.
+// The cage's edge sharpness is baked into the weights, so changing it means building the stencils again.
+void buildSubdivisionStencils(const HalfEdgeMesh& cage, int levels, HalfEdgeMesh& refined, StencilTable& stencils);
+
+// One more level on top of what buildSubdivisionStencils made: subdivides refined again and replaces its stencils (over
+// numCage cage vertices) with ones for the new vertices. The dependents are left for the caller to build
+void addSubdivisionLevel(Index numCage, HalfEdgeMesh& refined, StencilTable& stencils);
+
+// One level of subdivision in stencil form: prev holds a stencil per vertex of m, and is replaced by a stencil per vertex
+// of the mesh m.catmullClarkSelected(refineFace) would give. All true is the same as catmullClark
+void subdivideStencils(const HalfEdgeMesh& m, const std::vector<bool>& refineFace, Index numCage, StencilTable& prev);
+
+// out row i = sum over outer row i of weight * (inner row source), i.e. outer applied after inner.
+// inner's sources are numCage cage vertices
+void composeStencils(const StencilTable& outer, const StencilTable& inner, Index numCage, StencilTable& out);
+
+// Catmull-Clark limit masks for every vertex of the closed mesh m, as stencils over m's own vertices: position gives where
+// the vertex ends up after subdividing forever, and tangentU x tangentV is the direction of the limit normal there.
+// The masks are for smooth surfaces, so this returns false (leaving all three empty) if m has boundary or sharp edges
+bool buildLimitStencils(const HalfEdgeMesh& m, StencilTable& position, StencilTable& tangentU, StencilTable& tangentV);
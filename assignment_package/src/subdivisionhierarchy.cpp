@@ -0,0 +1,131 @@
+#include "subdivisionhierarchy.h"
+#include "debug.h"
+#include "parallel.h"
+#include <algorithm>
+#include <numeric>
+
+void SubdivisionHierarchy::setAdaptive(bool adaptive, const AdaptiveCriteria& criteria) {
+    this->adaptive = adaptive;
+    this->criteria = criteria;
+    levels.clear();
+}
+
+void SubdivisionHierarchy::setLimit(bool limit) {
+    if (limit == this->limit) return;
+    this->limit = limit;
+    levels.clear();
+}
+
+const SubdivisionHierarchy::Level& SubdivisionHierarchy::build(const HalfEdgeMesh& cage, int k) {
+    for (int next = levels.size() + 1; next <= k; next++) buildLevel(cage, next);
+    return levels[k - 1];
+}
+
+// catmullClark keeps each face's index for one of its pieces and adds the other n - 1 pieces of an n-gon at the end, in
+// face order. so given the cage face every face of m was cut from, this extends it to the faces m.catmullClark() adds
+static void subdivideCageFaces(const HalfEdgeMesh& m, std::vector<Index>& cageFace) {
+    for (Index f = 0; f < m.numFaces(); f++) {
+        const Index origin = cageFace[f];
+        cageFace.insert(cageFace.end(), m.faceDegree(f) - 1, origin);
+    }
+}
+
+void SubdivisionHierarchy::buildLevel(const HalfEdgeMesh& cage, int k) {
+    const Index numCage = cage.numVertices();
+    Level level;
+    if (adaptive) {
+        buildAdaptiveSubdivisionStencils(cage, k, criteria, level.mesh, level.stencils, &level.cageFace);
+    } else if (k == 1) {
+        buildSubdivisionStencils(cage, 1, level.mesh, level.stencils);
+        level.cageFace.resize(cage.numFaces());
+        std::iota(level.cageFace.begin(), level.cageFace.end(), 0);
+        subdivideCageFaces(cage, level.cageFace);
+    } else {
+        const Level& below = levels[k - 2];
+        level.mesh = below.mesh;
+        level.stencils = below.stencils;
+        level.cageFace = below.cageFace;
+        subdivideCageFaces(below.mesh, level.cageFace);
+        // a level on the limit surface has moved off its subdivided positions, which the next level is made from.
+        // its limit normals come along too, but then this level, with no more sharp edges than it, goes on the limit
+        // as well and replaces them
+        if (below.onLimit) below.stencils.apply(cage.positions, level.mesh.positions);
+        addSubdivisionLevel(numCage, level.mesh, level.stencils);
+        level.stencils.buildDependents(numCage);
+    }
+    if (limit) projectToLimit(cage, level);
+    buildFaceChildren(cage.numFaces(), level);
+    levels.push_back(std::move(level));
+}
+
+void SubdivisionHierarchy::buildFaceChildren(Index numCageFaces, Level& level) {
+    // a counting sort of the faces by the cage face they came from
+    level.faceChildStart.assign(numCageFaces + 1, 0);
+    for (Index f : level.cageFace) level.faceChildStart[f + 1]++;
+    for (Index f = 0; f < numCageFaces; f++) level.faceChildStart[f + 1] += level.faceChildStart[f];
+    level.faceChildren.resize(level.cageFace.size());
+    std::vector<Index> next(level.faceChildStart.begin(), level.faceChildStart.end() - 1);
+    for (Index f = 0; f < level.cageFace.size(); f++) level.faceChildren[next[level.cageFace[f]]++] = f;
+}
+
+void SubdivisionHierarchy::projectToLimit(const HalfEdgeMesh& cage, Level& level) {
+    // the limit masks are sums of refined vertices, which are sums of cage vertices, so they fold into the stencils
+    const Index numCage = cage.numVertices();
+    StencilTable position, tangentU, tangentV;
+    if (!buildLimitStencils(level.mesh, position, tangentU, tangentV)) {
+        LOG("no limit surface for a mesh with boundary or sharp edges, showing the subdivided mesh instead");
+        return;
+    }
+    level.onLimit = true;
+    composeStencils(position, level.stencils, numCage, level.limitStencils);
+    composeStencils(tangentU, level.stencils, numCage, level.tangentU);
+    composeStencils(tangentV, level.stencils, numCage, level.tangentV);
+    level.limitStencils.buildDependents(numCage);
+
+    level.limitStencils.apply(cage.positions, level.mesh.positions);
+    level.mesh.heNormal.assign(level.mesh.numHalfEdges(), glm::vec3(0.f));
+    // each vertex only writes the half-edges pointing to it
+    parallelFor(level.mesh.numVertices(), [&](std::size_t begin, std::size_t end) {
+        for (Index v = begin; v < end; v++) updateLimitNormal(cage, level, v);
+    }, 1024);
+}
+
+void SubdivisionHierarchy::updateLimitNormal(const HalfEdgeMesh& cage, Level& level, Index v) {
+    HalfEdgeMesh& m = level.mesh;
+    if (m.vertexEdge[v] == NO_INDEX) return;
+    glm::vec3 n = glm::cross(level.tangentU.evaluate(cage.positions, v), level.tangentV.evaluate(cage.positions, v));
+    float len = glm::length(n);
+    if (len > 0.f) n /= len;
+    Index cur = m.vertexEdge[v];
+    do {
+        m.heNormal[cur] = n;
+        cur = m.heSym[m.heNext[cur]];
+    } while (cur != m.vertexEdge[v]);
+}
+
+void SubdivisionHierarchy::vertexMoved(const HalfEdgeMesh& cage, Index v, std::vector<std::vector<Index>>& moved) {
+    moved.resize(levels.size());
+    for (Index i = 0; i < levels.size(); i++) {
+        Level& level = levels[i];
+        const StencilTable& stencils = level.onLimit ? level.limitStencils : level.stencils;
+        moved[i].assign(stencils.dependents.begin() + stencils.dependentStart[v],
+                        stencils.dependents.begin() + stencils.dependentStart[v + 1]);
+        stencils.applyRows(cage.positions, level.mesh.positions, moved[i]);
+        if (level.onLimit) {
+            for (Index rv : moved[i]) updateLimitNormal(cage, level, rv);
+        } else {
+            // the corner normals came down from the cage's, which no longer fit around v
+            for (Index rv : moved[i]) level.mesh.updateVertexNormals(rv);
+        }
+    }
+}
+
+void SubdivisionHierarchy::faceRecolored(const HalfEdgeMesh& cage, Index f, std::vector<std::vector<Index>>& recolored) {
+    recolored.resize(levels.size());
+    for (Index i = 0; i < levels.size(); i++) {
+        Level& level = levels[i];
+        recolored[i].assign(level.faceChildren.begin() + level.faceChildStart[f],
+                            level.faceChildren.begin() + level.faceChildStart[f + 1]);
+        for (Index child : recolored[i]) level.mesh.faceColors[child] = cage.faceColors[f];
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <halfedgemesh.h>
+#include <stenciltable.h>
+#include <adaptivesubdivision.h>
+#include <vector>
+
+/*
+The subdivision levels of a cage, from 1 up to the deepest one asked for so far, kept so that going back and forth
+between them doesn't subdivide again. Each level is a refined mesh with stencils from the cage (see stenciltable.h), so
+moving a cage vertex only re-evaluates the refined vertices it reaches, on every level at once, and whichever level is
+asked for next is ready as it is.
+A uniform level is built from the one below it, since that is all one more catmullClark needs. An adaptive level depends
+on which faces every level before it picked, so it is built from the cage.
+The levels only stay valid while the cage keeps its topology, sharpness and corner attributes; after any other change
+than moving vertices or recoloring faces, clear() them.
+*/
+class SubdivisionHierarchy
+{
+public:
+    struct Level
+    {
+        // the subdivided cage. on the limit surface when onLimit, with the limit normals on its corners
+        HalfEdgeMesh mesh;
+        // the subdivided positions, from the cage
+        StencilTable stencils;
+        // with onLimit: the limit positions, and the two tangents whose cross product is the normal, from the cage.
+        // a level with boundary or sharp edges left has no limit masks, and stays subdivided
+        bool onLimit = false;
+        StencilTable limitStencils, tangentU, tangentV;
+        // the cage face each face was cut from, and back: the faces cut from cage face f are
+        // faceChildren[faceChildStart[f]] up to faceChildren[faceChildStart[f + 1]], in order
+        std::vector<Index> cageFace;
+        std::vector<Index> faceChildStart, faceChildren;
+    };
+
+private:
+    std::vector<Level> levels;  // levels[k - 1] is level k
+    // how levels are made
+    bool adaptive = false;
+    AdaptiveCriteria criteria;
+    bool limit = false;
+
+    void buildLevel(const HalfEdgeMesh& cage, int k);
+    static void buildFaceChildren(Index numCageFaces, Level& level);
+    void projectToLimit(const HalfEdgeMesh& cage, Level& level);
+    // recomputes the limit normal at refined vertex v and puts it on every corner there
+    void updateLimitNormal(const HalfEdgeMesh& cage, Level& level, Index v);
+
+public:
+    // drops every level
+    void clear() {levels.clear();}
+    int numLevels() const {return levels.size();}
+
+    // changing how levels are made drops the ones built so far
+    void setAdaptive(bool adaptive, const AdaptiveCriteria& criteria);
+    bool isAdaptive() const {return adaptive;}
+    void setLimit(bool limit);
+    bool isLimit() const {return limit;}
+
+    // level k >= 1 of cage, building it (and any level below it) first if it isn't yet
+    const Level& build(const HalfEdgeMesh& cage, int k);
+    // level k >= 1, which must be built already
+    const Level& level(int k) const {return levels[k - 1];}
+
+    // after cage vertex v moved: moves the refined vertices v reaches on every level built, and gives them new corner
+    // normals if the levels have any. moved[k - 1] lists the ones on level k
+    void vertexMoved(const HalfEdgeMesh& cage, Index v, std::vector<std::vector<Index>>& moved);
+    // after the color of cage face f changed: passes it on to the faces cut from f on every level built.
+    // recolored[k - 1] lists the ones on level k
+    void faceRecolored(const HalfEdgeMesh& cage, Index f, std::vector<std::vector<Index>>& recolored);
+};
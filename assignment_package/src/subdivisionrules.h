@@ -0,0 +1,145 @@
+#pragma once
+#include <halfedgemesh.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/*
+The subdivision rules for creases and boundaries, written once for everything that subdivides: HalfEdgeMesh itself and
+the stencil tables. A rule gives a new point as a weighted sum of old vertices and old face centroids, through callbacks
+    vertex(u, w)      w times old vertex u
+    centroid(f, w)    w times the centroid of old face f (Catmull-Clark only)
+so the caller decides whether that means adding up positions or stencil rows. All of them read the mesh as it is before
+the level, so every new position has to be worked out before any topology changes.
+
+An edge is sharp if it is on the boundary or has a sharpness of 1 or more. Its edge point is then just its midpoint.
+Between 0 and 1 (semi-sharp) the smooth and sharp points are blended by the sharpness. A vertex goes by how many sharp or
+semi-sharp edges it has:
+    fewer than 2    smooth (a single one is a dart, which stays smooth)
+    2               crease: 3/4 of itself and 1/8 of each of the other two ends, so it only moves along the crease
+    more than 2     corner: stays where it is
+blended with the smooth rule by the average sharpness of those edges, the same way. A boundary vertex with only one face
+counts as a corner as well, so the corners of an open sheet stay pinned.
+*/
+
+// boundary edges are infinitely sharp
+inline float ruleSharpness(const HalfEdgeMesh& m, Index he) {
+    return m.isBoundary(he) ? std::numeric_limits<float>::infinity() : m.sharpness(he);
+}
+
+// the sharpness both halves of an edge have after it is split
+inline float childSharpness(float s) {
+    return std::max(s - 1.f, 0.f);
+}
+
+// Loop's weight for each neighbour of a smooth vertex with n of them. the vertex itself keeps 1 - n*beta
+inline float loopBeta(int n) {
+    const float PI = 3.14159265358979f;
+    float c = 0.375f + 0.25f*std::cos(2.f*PI/n);
+    return (0.625f - c*c) / n;
+}
+
+// the point on he's edge. smooth(w) adds w times the scheme's smooth edge point
+template<class AddVertex, class Smooth>
+void creasedEdgePoint(const HalfEdgeMesh& m, Index he, AddVertex&& vertex, Smooth&& smooth) {
+    float s = std::min(ruleSharpness(m, he), 1.f);
+    if (s < 1.f) smooth(1.f - s);
+    if (s > 0.f) {
+        vertex(m.heVertex[he], 0.5f*s);
+        vertex(m.sourceVertex(he), 0.5f*s);
+    }
+}
+
+// the new position of old vertex v. smooth(w, n) adds w times the scheme's smooth vertex point, for v with n faces
+// around it; it is only called for a vertex off the boundary
+template<class AddVertex, class Smooth>
+void creasedVertexPoint(const HalfEdgeMesh& m, Index v, AddVertex&& vertex, Smooth&& smooth) {
+    int numFaces = 0;
+    int numSharp = 0;
+    float sumSharpness = 0.f;
+    Index creaseEnds[2] = {v, v};
+    bool onBoundary = false;
+    auto sharpEdge = [&](Index he, Index otherEnd) {
+        float s = ruleSharpness(m, he);
+        if (s <= 0.f) return;
+        if (numSharp < 2) creaseEnds[numSharp] = otherEnd;
+        numSharp++;
+        sumSharpness += s;
+        onBoundary = onBoundary || m.isBoundary(he);
+    };
+    m.forEachIncoming(v, [&](Index he) {
+        numFaces++;
+        sharpEdge(he, m.sourceVertex(he));
+        // the edge leaving v on this face only shows up here when there is no face on its other side
+        Index out = m.heNext[he];
+        if (m.isBoundary(out)) sharpEdge(out, m.heVertex[out]);
+    });
+
+    if (numFaces == 0) {  // on no face, so nothing to average
+        vertex(v, 1.f);
+        return;
+    }
+    if (numSharp < 2) {
+        smooth(1.f, numFaces);
+        return;
+    }
+    float s = std::min(sumSharpness / numSharp, 1.f);
+    if (s < 1.f) smooth(1.f - s, numFaces);
+    if (numSharp > 2 || (onBoundary && numFaces == 1)) {
+        vertex(v, s);
+    } else {
+        vertex(v, 0.75f*s);
+        vertex(creaseEnds[0], 0.125f*s);
+        vertex(creaseEnds[1], 0.125f*s);
+    }
+}
+
+// Catmull-Clark: the smooth edge point is 1/4 of each end and each neighbouring centroid
+template<class AddVertex, class AddCentroid>
+void catmullClarkEdgePoint(const HalfEdgeMesh& m, Index he, AddVertex&& vertex, AddCentroid&& centroid) {
+    creasedEdgePoint(m, he, vertex, [&](float w) {
+        Index sym = m.heSym[he];
+        vertex(m.heVertex[he], 0.25f*w);
+        vertex(m.heVertex[sym], 0.25f*w);
+        centroid(m.heFace[he], 0.25f*w);
+        centroid(m.heFace[sym], 0.25f*w);
+    });
+}
+
+// Catmull-Clark: a smooth vertex of valence n moves to (n-2)/n of itself, plus 1/n^2 of each neighbour and of each
+// centroid around it
+template<class AddVertex, class AddCentroid>
+void catmullClarkVertexPoint(const HalfEdgeMesh& m, Index v, AddVertex&& vertex, AddCentroid&& centroid) {
+    creasedVertexPoint(m, v, vertex, [&](float w, int n) {
+        float frac = 1.f/n;
+        vertex(v, w*frac*(n-2));
+        m.forEachIncoming(v, [&](Index he) {
+            vertex(m.heVertex[m.heSym[he]], w*frac*frac);
+            centroid(m.heFace[he], w*frac*frac);
+        });
+    });
+}
+
+// Loop: the smooth edge point is 3/8 of each end and 1/8 of the corner opposite it in each of its two triangles
+template<class AddVertex>
+void loopEdgePoint(const HalfEdgeMesh& m, Index he, AddVertex&& vertex) {
+    creasedEdgePoint(m, he, vertex, [&](float w) {
+        Index sym = m.heSym[he];
+        vertex(m.heVertex[he], 0.375f*w);
+        vertex(m.heVertex[sym], 0.375f*w);
+        vertex(m.heVertex[m.heNext[he]], 0.125f*w);
+        vertex(m.heVertex[m.heNext[sym]], 0.125f*w);
+    });
+}
+
+// Loop: a smooth vertex with n neighbours keeps 1 - n*beta of itself and takes beta of each neighbour
+template<class AddVertex>
+void loopVertexPoint(const HalfEdgeMesh& m, Index v, AddVertex&& vertex) {
+    creasedVertexPoint(m, v, vertex, [&](float w, int n) {
+        float beta = loopBeta(n);
+        vertex(v, w*(1.f - n*beta));
+        m.forEachIncoming(v, [&](Index he) {
+            vertex(m.heVertex[m.heSym[he]], w*beta);
+        });
+    });
+}
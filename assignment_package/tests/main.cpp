@@ -0,0 +1,593 @@
+#include <adaptivesubdivision.h>
+#include <dirtyflags.h>
+#include <halfedgemesh.h>
+#include <limitsurface.h>
+#include <meshfile.h>
+#include <objreader.h>
+#include <operations.h>
+#include <parallel.h>
+#include <stenciltable.h>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+/*
+meshtests: checks the promises the kernel makes about itself, on the sample meshes and a few generated ones, one
+test function per feature. Each failed check is printed with where it is; the exit code is the number of failures
+(0 when everything passes).
+*/
+
+static int numFailed = 0;
+
+#define CHECK(cond, what)                                                                              \
+    do {                                                                                               \
+        if (!(cond)) {                                                                                 \
+            std::cout << __FILE__ << "(" << __LINE__ << "): FAILED " << #cond << " (" << what << ")\n"; \
+            numFailed++;                                                                               \
+        }                                                                                              \
+    } while (false)
+
+struct TestMesh
+{
+    std::string name;
+    HalfEdgeMesh mesh;
+};
+
+// (n+1) x (n+1) vertices on a bumpy plane, so it has a boundary and isn't flat
+static std::vector<glm::vec3> gridPositions(int n) {
+    std::vector<glm::vec3> positions;
+    for (int i = 0; i <= n; i++) {
+        for (int j = 0; j <= n; j++) positions.push_back({float(i), float(j), 0.1f * ((i * 7 + j * 3) % 5)});
+    }
+    return positions;
+}
+
+static HalfEdgeMesh openGrid(int n) {
+    std::vector<std::vector<int>> faces;
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            int a = i * (n + 1) + j;
+            faces.push_back({a, a + n + 1, a + n + 2, a + 1});
+        }
+    }
+    HalfEdgeMesh mesh;
+    mesh.buildMesh(gridPositions(n), faces);
+    return mesh;
+}
+
+// the same grid with every square cut into two triangles, for Loop subdivision on a boundary
+static HalfEdgeMesh triGrid(int n) {
+    std::vector<std::vector<int>> faces;
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            int a = i * (n + 1) + j;
+            faces.push_back({a, a + n + 1, a + n + 2});
+            faces.push_back({a, a + n + 2, a + 1});
+        }
+    }
+    HalfEdgeMesh mesh;
+    mesh.buildMesh(gridPositions(n), faces);
+    return mesh;
+}
+
+// the vertices and faces of a closed all-quad torus, every vertex regular, as buildMesh takes them
+static void torusFaces(int nu, int nv, std::vector<glm::vec3>& positions, std::vector<std::vector<int>>& faces) {
+    for (int i = 0; i < nu; i++) {
+        for (int j = 0; j < nv; j++) {
+            float u = 6.2831853f * i / nu, v = 6.2831853f * j / nv;
+            positions.push_back({(2 + std::cos(v)) * std::cos(u), (2 + std::cos(v)) * std::sin(u), std::sin(v)});
+            faces.push_back({i * nv + j, (i + 1) % nu * nv + j, (i + 1) % nu * nv + (j + 1) % nv, i * nv + (j + 1) % nv});
+        }
+    }
+}
+
+static HalfEdgeMesh torus(int nu, int nv) {
+    std::vector<glm::vec3> positions;
+    std::vector<std::vector<int>> faces;
+    torusFaces(nu, nv, positions, faces);
+    HalfEdgeMesh mesh;
+    mesh.buildMesh(positions, faces);
+    return mesh;
+}
+
+static HalfEdgeMesh loadOBJ(const std::string& path) {
+    ObjData obj;
+    HalfEdgeMesh mesh;
+    CHECK(readOBJ(path, obj), path);
+    mesh.buildMesh(obj);
+    return mesh;
+}
+
+static std::vector<TestMesh> testMeshes() {
+    std::vector<TestMesh> meshes;
+    meshes.push_back({"cube", loadOBJ(OBJ_FILES_DIR "/cube.obj")});
+    meshes.push_back({"dodecahedron", loadOBJ(OBJ_FILES_DIR "/dodecahedron.obj")});
+    meshes.push_back({"cow", loadOBJ(OBJ_FILES_DIR "/cow.obj")});
+    meshes.push_back({"grid", openGrid(40)});
+    meshes.push_back({"trigrid", triGrid(40)});
+    meshes.push_back({"torus", torus(60, 40)});
+    // an extraordinary vertex and a triangle on the torus, so every rule gets used
+    meshes.back().mesh.splitEdge(3);
+    meshes.back().mesh.triangulateFace(0);
+    return meshes;
+}
+
+// every array, compared bit for bit
+static bool sameMesh(const HalfEdgeMesh& a, const HalfEdgeMesh& b) {
+    return a.positions == b.positions && a.vertexEdge == b.vertexEdge && a.faceColors == b.faceColors &&
+           a.faceEdge == b.faceEdge && a.heNext == b.heNext && a.heSym == b.heSym && a.heVertex == b.heVertex &&
+           a.heFace == b.heFace && a.heUV == b.heUV && a.heNormal == b.heNormal && a.heSharpness == b.heSharpness;
+}
+
+// runs make() on one thread, then on 2 and 8, and checks every run gives the same mesh.
+// buildMesh colors the faces with rand(), so every run starts from the same seed
+template <class F>
+static void checkThreadCounts(const std::string& what, F&& make) {
+    const unsigned threads = threadCount();
+    setThreadCount(1);
+    std::srand(1);
+    const HalfEdgeMesh serial = make();
+    for (unsigned t : {2u, 8u}) {
+        setThreadCount(t);
+        std::srand(1);
+        CHECK(sameMesh(make(), serial), what << " on " << t << " threads");
+    }
+    setThreadCount(threads);
+}
+
+static void testParallelCatmullClark(const std::vector<TestMesh>& meshes) {
+    for (const TestMesh& test : meshes) {
+        // enough levels that every mesh ends up big enough to be split over the threads
+        const int levels = test.mesh.numFaces() > 1000 ? 2 : 4;
+        checkThreadCounts(test.name + " catmullClark", [&]() {
+            HalfEdgeMesh mesh = test.mesh;
+            for (int level = 0; level < levels; level++) mesh.catmullClark();
+            return mesh;
+        });
+    }
+}
+
+static void testParallelBuildMesh() {
+    // the faces are split over the threads in blocks of a few thousand, so this needs a few hundred thousand of them
+    std::vector<glm::vec3> positions;
+    std::vector<std::vector<int>> faces;
+    torusFaces(600, 600, positions, faces);
+    checkThreadCounts("buildMesh", [&]() {
+        HalfEdgeMesh mesh;
+        mesh.buildMesh(positions, faces);
+        return mesh;
+    });
+}
+
+static bool isTriangleMesh(const HalfEdgeMesh& mesh) {
+    for (Index f = 0; f < mesh.numFaces(); f++) {
+        if (mesh.faceDegree(f) != 3) return false;
+    }
+    return true;
+}
+
+static void testParallelLoop(const std::vector<TestMesh>& meshes) {
+    for (const TestMesh& test : meshes) {
+        const int levels = test.mesh.numFaces() > 1000 ? 2 : 4;
+        checkThreadCounts(test.name + " loopSubdivision", [&]() {
+            HalfEdgeMesh mesh = test.mesh;
+            if (!isTriangleMesh(mesh)) mesh.triangulateAllFaces();
+            for (int level = 0; level < levels; level++) mesh.loopSubdivision();
+            return mesh;
+        });
+    }
+}
+
+static bool sameObj(const ObjData& a, const ObjData& b) {
+    return a.positions == b.positions && a.uvs == b.uvs && a.normals == b.normals && a.faceCorners == b.faceCorners &&
+           a.cornerUVs == b.cornerUVs && a.cornerNormals == b.cornerNormals && a.faceStart == b.faceStart;
+}
+
+static void testParallelReadOBJ() {
+    // a file is only cut into chunks at a few million bytes per thread. every other face counts back from the end,
+    // and all of the faces come after all of the vertices, so the relative ones resolve across chunk boundaries
+    std::vector<glm::vec3> positions;
+    std::vector<std::vector<int>> faces;
+    torusFaces(500, 500, positions, faces);
+    const std::string path = (std::filesystem::temp_directory_path() / "meshtests_chunks.obj").string();
+    {
+        std::ofstream out(path);
+        for (const glm::vec3& p : positions) out << "v " << p.x << ' ' << p.y << ' ' << p.z << '\n';
+        for (const glm::vec3& p : positions) out << "vt " << p.x << ' ' << p.y << '\n';
+        const int numVertices = positions.size();
+        for (std::size_t f = 0; f < faces.size(); f++) {
+            out << 'f';
+            for (int v : faces[f]) {
+                const int idx = f % 2 ? v - numVertices : v + 1;
+                out << ' ' << idx << '/' << idx;
+            }
+            out << '\n';
+        }
+    }
+
+    const unsigned threads = threadCount();
+    setThreadCount(1);
+    ObjData serial;
+    CHECK(readOBJ(path, serial), path);
+    bool resolved = serial.numFaces() == faces.size();
+    for (std::size_t f = 0; resolved && f < faces.size(); f++) {
+        for (std::size_t c = 0; c < faces[f].size(); c++) {
+            resolved = resolved && serial.faceCorners[serial.faceStart[f] + c] == faces[f][c] &&
+                       serial.cornerUVs[serial.faceStart[f] + c] == faces[f][c];
+        }
+    }
+    CHECK(resolved, path);
+    for (unsigned t : {2u, 8u}) {
+        setThreadCount(t);
+        ObjData obj;
+        CHECK(readOBJ(path, obj), path);
+        CHECK(sameObj(obj, serial), "readOBJ on " << t << " threads");
+    }
+    setThreadCount(threads);
+    std::filesystem::remove(path);
+}
+
+static void testMalformedOBJ() {
+    // faces pointing past the vertices, uvs or normals are dropped and the rest builds normally
+    ObjData obj;
+    CHECK(readOBJ(TEST_DATA_DIR "/bad_indices.obj", obj), "bad_indices.obj");
+    CHECK(obj.numFaces() == 1, "bad_indices.obj");
+    HalfEdgeMesh mesh;
+    mesh.buildMesh(obj);
+    CHECK(mesh.numFaces() == 1 && mesh.numHalfEdges() == 3 && mesh.hasUVs() && mesh.hasNormals(), "bad_indices.obj");
+
+    // something that can't be mapped fails and leaves what was read before alone
+    for (const char* path : {TEST_DATA_DIR, TEST_DATA_DIR "/missing.obj"}) {
+        CHECK(!readOBJ(path, obj), path);
+        CHECK(obj.numFaces() == 1, path);
+    }
+    // while an empty file is just an empty mesh
+    const std::string empty = (std::filesystem::temp_directory_path() / "meshtests_empty.obj").string();
+    std::ofstream(empty).close();
+    CHECK(readOBJ(empty, obj) && obj.positions.empty() && obj.numFaces() == 0, empty);
+    std::filesystem::remove(empty);
+}
+
+static std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+}
+
+static void writeFile(const std::string& path, const std::string& data) {
+    std::ofstream(path, std::ios::binary) << data;
+}
+
+// a copy of the .hem file `good` with the word at `offset` replaced
+static void writeCorrupted(const std::string& good, const std::string& path, std::size_t offset, std::uint32_t word) {
+    std::string data = readFile(good);
+    std::memcpy(&data[offset], &word, sizeof(word));
+    writeFile(path, data);
+}
+
+static void testMeshFile() {
+    // a written mesh reads back exactly
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    const std::string good = (dir / "meshtests_good.hem").string(), bad = (dir / "meshtests_bad.hem").string();
+    HalfEdgeMesh cube = loadOBJ(OBJ_FILES_DIR "/cube.obj");
+    CHECK(writeMeshFile(good, cube), good);
+    HalfEdgeMesh mesh;
+    CHECK(readMeshFile(good, mesh) && sameMesh(mesh, cube), good);
+
+    // a .hem that gets past the header but points outside its arrays is rejected, and leaves the mesh alone
+    const std::size_t V = cube.numVertices(), F = cube.numFaces(), H = cube.numHalfEdges();
+    const std::size_t flags = 12, heNext = 32 + V * 16 + F * 16, heSym = heNext + H * 4, heVertex = heSym + H * 4;
+    const std::size_t vertexEdge = 32 + V * 12, heFace = heVertex + H * 4;
+    struct Corruption
+    {
+        const char* what;
+        std::size_t offset;
+        std::uint32_t word;
+    };
+    for (const Corruption& c : {Corruption{"unknown flag", flags, 8}, Corruption{"heNext", heNext, 1000000},
+                                Corruption{"heNext NO_INDEX", heNext, NO_INDEX}, Corruption{"heSym", heSym + 4, Index(H)},
+                                Corruption{"heVertex", heVertex + 8, Index(V)}, Corruption{"heFace", heFace, Index(F)},
+                                Corruption{"vertexEdge", vertexEdge, Index(H)}}) {
+        writeCorrupted(good, bad, c.offset, c.word);
+        CHECK(!readMeshFile(bad, mesh), c.what);
+        CHECK(sameMesh(mesh, cube), c.what);
+    }
+    // a boundary half-edge is allowed a NO_INDEX sym
+    writeCorrupted(good, bad, heSym, NO_INDEX);
+    CHECK(readMeshFile(bad, mesh), "heSym NO_INDEX");
+    // and a file cut short is caught by its size
+    writeFile(bad, readFile(good).substr(0, 32 + V * 16));
+    CHECK(!readMeshFile(bad, mesh), "truncated");
+    std::filesystem::remove(good);
+    std::filesystem::remove(bad);
+}
+
+static bool sameTopology(const HalfEdgeMesh& a, const HalfEdgeMesh& b) {
+    return a.vertexEdge == b.vertexEdge && a.faceEdge == b.faceEdge && a.heNext == b.heNext && a.heSym == b.heSym &&
+           a.heVertex == b.heVertex && a.heFace == b.heFace;
+}
+
+// the largest coordinate difference between a[i] and b[i] for the first n, relative to the size of the mesh
+static float maxDifference(const std::vector<glm::vec3>& a, const std::vector<glm::vec3>& b, std::size_t n) {
+    float size = 1.f, diff = 0.f;
+    for (std::size_t i = 0; i < n; i++) {
+        glm::vec3 d = glm::abs(a[i] - b[i]);
+        diff = std::max(diff, std::max(d.x, std::max(d.y, d.z)));
+        size = std::max(size, std::max(std::abs(a[i].x), std::max(std::abs(a[i].y), std::abs(a[i].z))));
+    }
+    return diff / size;
+}
+
+static void testStencils(const std::vector<TestMesh>& meshes) {
+    for (const TestMesh& test : meshes) {
+        const int levels = test.mesh.numFaces() > 1000 ? 2 : 3;
+        HalfEdgeMesh direct = test.mesh;
+        for (int level = 0; level < levels; level++) direct.catmullClark();
+
+        HalfEdgeMesh refined;
+        StencilTable stencils;
+        buildSubdivisionStencils(test.mesh, levels, refined, stencils);
+        CHECK(sameTopology(refined, direct), test.name);
+        CHECK(stencils.numStencils() == direct.numVertices(), test.name);
+        if (stencils.numStencils() != direct.numVertices()) continue;
+        std::vector<glm::vec3> positions(stencils.numStencils());
+        stencils.apply(test.mesh.positions, positions);
+        CHECK(maxDifference(positions, direct.positions, positions.size()) < 1e-5f, test.name);
+    }
+}
+
+static void testAdaptive(const std::vector<TestMesh>& meshes) {
+    for (const TestMesh& test : meshes) {
+        for (float bend : {0.f, 10.f}) {
+            AdaptiveCriteria criteria;
+            criteria.maxBendDegrees = bend;
+            HalfEdgeMesh direct = test.mesh;
+            adaptiveCatmullClark(direct, 3, criteria);
+
+            HalfEdgeMesh refined;
+            StencilTable stencils;
+            buildAdaptiveSubdivisionStencils(test.mesh, 3, criteria, refined, stencils);
+            CHECK(sameTopology(refined, direct), test.name << " bend " << bend);
+            CHECK(stencils.numStencils() == direct.numVertices(), test.name << " bend " << bend);
+            if (stencils.numStencils() != direct.numVertices()) continue;
+            std::vector<glm::vec3> positions(stencils.numStencils());
+            stencils.apply(test.mesh.positions, positions);
+            CHECK(maxDifference(positions, direct.positions, positions.size()) < 1e-5f, test.name << " bend " << bend);
+        }
+    }
+}
+
+// parses args as meshtool would, after the input file
+static bool parse(const std::vector<std::string>& args, std::vector<Operation>& ops) {
+    ops.clear();
+    return parseOperations(args, ops);
+}
+
+static void testMeshtool() {
+    std::vector<Operation> ops;
+    const std::vector<std::vector<std::string>> badArgs = {
+        {"-s"}, {"-s", "-1"}, {"-s", "2x"}, {"-b", "200"}, {"-c", "cubic"}, {"-o", "out.ply"}, {"-j", "0"}, {"--nope"}};
+    for (const std::vector<std::string>& args : badArgs) CHECK(!parse(args, ops), args[0] << " " << args.size());
+
+    // -b and -c apply to the operations after them, not before
+    CHECK(parse({"-s", "1", "-b", "10", "-c", "linear", "-a", "2", "-l", "-t"}, ops) && ops.size() == 4, "parse");
+    if (ops.size() == 4) {
+        CHECK(ops[0].type == Operation::SUBDIVIDE && ops[0].count == 1 &&
+              ops[0].corners == CornerInterpolation::SMOOTH, "parse -s");
+        CHECK(ops[1].type == Operation::ADAPTIVE && ops[1].count == 2 && ops[1].bend == 10.f &&
+              ops[1].corners == CornerInterpolation::LINEAR, "parse -a");
+        CHECK(ops[2].type == Operation::LIMIT && ops[3].type == Operation::TRIANGULATE, "parse -l -t");
+    }
+
+    // each operation does what the kernel call it stands for does
+    const HalfEdgeMesh cube = loadOBJ(OBJ_FILES_DIR "/cube.obj");
+    HalfEdgeMesh mesh = cube, direct = cube;
+    CHECK(parse({"-s", "2", "-t"}, ops) && applyOperations(ops, mesh), "-s 2 -t");
+    for (int level = 0; level < 2; level++) direct.catmullClark();
+    direct.triangulateAllFaces();
+    CHECK(sameMesh(mesh, direct), "-s 2 -t");
+
+    mesh = cube;
+    direct = cube;
+    CHECK(parse({"-t", "-L", "2"}, ops) && applyOperations(ops, mesh), "-t -L 2");
+    direct.triangulateAllFaces();
+    for (int level = 0; level < 2; level++) direct.loopSubdivision();
+    CHECK(sameMesh(mesh, direct), "-t -L 2");
+
+    mesh = cube;
+    direct = cube;
+    CHECK(parse({"-b", "10", "-a", "3"}, ops) && applyOperations(ops, mesh), "-b 10 -a 3");
+    AdaptiveCriteria criteria;
+    criteria.maxBendDegrees = 10.f;
+    adaptiveCatmullClark(direct, 3, criteria);
+    CHECK(sameMesh(mesh, direct), "-b 10 -a 3");
+
+    // outputs happen in order, and read back as what was written
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    const std::string hem = (dir / "meshtests_tool.hem").string(), obj = (dir / "meshtests_tool.obj").string();
+    mesh = cube;
+    CHECK(parse({"-o", hem, "-s", "1", "-o", obj}, ops) && applyOperations(ops, mesh), "-o");
+    HalfEdgeMesh read;
+    CHECK(readInput(hem, read) && sameMesh(read, cube), hem);
+    CHECK(readInput(obj, read) && read.numFaces() == mesh.numFaces() && read.numVertices() == mesh.numVertices(), obj);
+    std::filesystem::remove(hem);
+    std::filesystem::remove(obj);
+
+    // an open mesh has no limit surface to move onto
+    HalfEdgeMesh grid = openGrid(4);
+    CHECK(parse({"-l"}, ops) && !applyOperations(ops, grid), "-l on an open grid");
+}
+
+static bool isClosed(const HalfEdgeMesh& mesh) {
+    for (Index he = 0; he < mesh.numHalfEdges(); he++) {
+        if (mesh.isBoundary(he)) return false;
+    }
+    return true;
+}
+
+static void testLimit(const std::vector<TestMesh>& meshes) {
+    for (const TestMesh& test : meshes) {
+        std::vector<glm::vec3> positions, normals;
+        const bool closed = isClosed(test.mesh);
+        CHECK(limitVertices(test.mesh, positions, normals) == closed, test.name);
+        if (!closed) continue;
+
+        // a vertex keeps its index through catmullClark, and its distance to the limit shrinks about fourfold a level
+        HalfEdgeMesh deep = test.mesh;
+        const int levels = test.mesh.numFaces() > 1000 ? 4 : 7;
+        for (int level = 0; level < levels; level++) deep.catmullClark();
+        CHECK(maxDifference(positions, deep.positions, test.mesh.numVertices()) < std::pow(0.25f, levels), test.name);
+    }
+}
+
+// vertices where faces meet in more than one fan (cow.obj has one). each fan has its own limit there, and
+// limitVertices only sees the one through vertexEdge
+static std::vector<bool> pinchedVertices(const HalfEdgeMesh& mesh) {
+    std::vector<int> valence(mesh.numVertices(), 0);
+    for (Index he = 0; he < mesh.numHalfEdges(); he++) valence[mesh.heVertex[he]]++;
+    std::vector<bool> pinched(mesh.numVertices(), false);
+    for (Index v = 0; v < mesh.numVertices(); v++) {
+        if (mesh.vertexEdge[v] == NO_INDEX) continue;
+        int fan = 0;
+        Index cur = mesh.vertexEdge[v];
+        do {
+            fan++;
+            cur = mesh.heSym[mesh.heNext[cur]];
+        } while (cur != mesh.vertexEdge[v]);
+        pinched[v] = fan != valence[v];
+    }
+    return pinched;
+}
+
+static void testEvaluateLimit(const std::vector<TestMesh>& meshes) {
+    for (const TestMesh& test : meshes) {
+        if (!isClosed(test.mesh)) continue;
+        // evaluateLimit wants quads with at most one extraordinary corner, which two levels give any mesh
+        HalfEdgeMesh patches = test.mesh;
+        patches.catmullClark();
+        patches.catmullClark();
+        // one more level puts a vertex at each corner and the middle of every patch: corner vertices keep their
+        // index, and the point in the middle of face f is vertex numVertices() + f
+        HalfEdgeMesh finer = patches;
+        finer.catmullClark();
+        std::vector<glm::vec3> positions, normals;
+        CHECK(limitVertices(finer, positions, normals), test.name);
+
+        const std::vector<bool> pinched = pinchedVertices(patches);
+
+        float positionError = 0.f, normalError = 0.f;
+        bool evaluated = true;
+        for (Index f = 0; f < patches.numFaces(); f++) {
+            const Index he = patches.faceEdge[f];
+            Index corner = he;
+            bool touchesPinch = false;
+            for (int c = 0; c < 4; c++, corner = patches.heNext[corner]) {
+                touchesPinch = touchesPinch || pinched[patches.heVertex[corner]];
+            }
+            if (touchesPinch) continue;
+            const struct {float u, v; Index vertex;} samples[] = {
+                {0.f, 0.f, patches.heVertex[he]}, {1.f, 0.f, patches.heVertex[patches.heNext[he]]},
+                {0.f, 1.f, patches.heVertex[patches.prevEdge(he)]}, {0.5f, 0.5f, patches.numVertices() + f}};
+            for (const auto& sample : samples) {
+                glm::vec3 position, normal;
+                evaluated = evaluated && evaluateLimit(patches, f, sample.u, sample.v, position, normal);
+                positionError = std::max(positionError, glm::length(position - positions[sample.vertex]));
+                normalError = std::max(normalError, glm::length(normal - normals[sample.vertex]));
+            }
+        }
+        CHECK(evaluated, test.name);
+        CHECK(positionError < 1e-4f, test.name << " position " << positionError);
+        CHECK(normalError < 1e-3f, test.name << " normal " << normalError);
+    }
+}
+
+static void testMeshtoolLimit() {
+    // moving the mesh onto its limit in place must match limitVertices into a separate array, and keep the cube's
+    // mirror symmetry in x
+    const HalfEdgeMesh cube = loadOBJ(OBJ_FILES_DIR "/cube.obj");
+    std::vector<Operation> ops;
+    HalfEdgeMesh mesh = cube;
+    CHECK(parseOperations({"-l"}, ops) && applyOperations(ops, mesh), "-l");
+    std::vector<glm::vec3> positions, normals;
+    CHECK(limitVertices(cube, positions, normals), "cube");
+    CHECK(mesh.positions == positions, "-l positions");
+    CHECK(mesh.heUV == cube.heUV && mesh.numHalfEdges() == cube.numHalfEdges() && mesh.hasNormals(), "-l corners");
+
+    bool symmetric = true;
+    for (const glm::vec3& p : mesh.positions) {
+        bool mirrored = false;
+        for (const glm::vec3& q : mesh.positions) mirrored = mirrored || glm::length(q - glm::vec3(-p.x, p.y, p.z)) < 1e-6f;
+        symmetric = symmetric && mirrored;
+    }
+    CHECK(symmetric, "-l symmetry");
+}
+
+static void testDirtyFlags() {
+    DirtyFlags dirty;
+    // the first frame draws everything, whether or not anything was marked
+    CHECK(dirty.beginFrame() == (DIRTY_CAMERA | DIRTY_MESH | DIRTY_SELECTION) && dirty.frameCount() == 1, "first frame");
+    // a burst of changes asks for one repaint, which takes all of them
+    CHECK(dirty.mark(DIRTY_CAMERA), "first change");
+    CHECK(!dirty.mark(DIRTY_MESH) && !dirty.mark(DIRTY_CAMERA), "later changes");
+    CHECK(dirty.beginFrame() == (DIRTY_CAMERA | DIRTY_MESH) && dirty.frameCount() == 2, "burst");
+    // after a frame the next change asks again, and a frame with nothing marked has nothing to redo
+    CHECK(dirty.mark(DIRTY_SELECTION) && dirty.beginFrame() == DIRTY_SELECTION, "next change");
+    CHECK(dirty.beginFrame() == 0 && dirty.frameCount() == 4, "nothing changed");
+}
+
+static void testVertexNormals(const std::vector<TestMesh>& meshes) {
+    for (const TestMesh& test : meshes) {
+        if (!test.mesh.hasNormals()) continue;
+        const std::vector<bool> pinched = pinchedVertices(test.mesh);
+        Index v = 0;
+        while (pinched[v] || test.mesh.vertexEdge[v] == NO_INDEX) v++;
+        HalfEdgeMesh moved = test.mesh;
+        moved.positions[v] += glm::vec3(0.1f, 0.2f, -0.3f);
+        moved.updateVertexNormals(v);
+
+        // the normal at v, from every face that has it as a corner
+        glm::vec3 expected(0.f);
+        for (Index he = 0; he < moved.numHalfEdges(); he++) {
+            if (moved.heVertex[he] != v) continue;
+            Index cur = he;
+            do {
+                expected += glm::cross(moved.positions[moved.heVertex[cur]], moved.positions[moved.heVertex[moved.heNext[cur]]]);
+                cur = moved.heNext[cur];
+            } while (cur != he);
+        }
+        expected = glm::normalize(expected);
+        bool atV = true, elsewhere = true;
+        for (Index he = 0; he < moved.numHalfEdges(); he++) {
+            if (moved.heVertex[he] == v) atV = atV && glm::length(moved.heNormal[he] - expected) < 1e-5f;
+            else elsewhere = elsewhere && moved.heNormal[he] == test.mesh.heNormal[he];
+        }
+        CHECK(atV, test.name + " normals at the moved vertex");
+        CHECK(elsewhere, test.name + " normals elsewhere");
+    }
+}
+
+int main() {
+    const std::vector<TestMesh> meshes = testMeshes();
+    testParallelReadOBJ();
+    testParallelBuildMesh();
+    testParallelCatmullClark(meshes);
+    testParallelLoop(meshes);
+    testMalformedOBJ();
+    testMeshFile();
+    testStencils(meshes);
+    testAdaptive(meshes);
+    testMeshtool();
+    testLimit(meshes);
+    testEvaluateLimit(meshes);
+    testMeshtoolLimit();
+    testDirtyFlags();
+    testVertexNormals(meshes);
+    if (numFailed > 0) std::cout << numFailed << " checks failed\n";
+    else std::cout << "all checks passed\n";
+    return numFailed;
+}
@@ -0,0 +1,29 @@
+# Regression tests for the mesh kernel: builds against core.pri like meshtool, runs without Qt, and exits non-zero on a failure
+CONFIG -= qt
+CONFIG += console c++2a
+CONFIG += warn_on
+
+TARGET = meshtests
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../include $$PWD/../cli
+
+include(../src/core.pri)
+
+# meshtool's operations are tested through the same functions its main() calls
+SOURCES += $$PWD/main.cpp \
+    $$PWD/../cli/operations.cpp
+
+HEADERS += $$PWD/../cli/operations.h
+
+# the sample meshes shipped with the repo, and the inputs made for these tests
+DEFINES += OBJ_FILES_DIR=\\\"$$PWD/../../obj_files\\\"
+DEFINES += TEST_DATA_DIR=\\\"$$PWD/data\\\"
+
+unix: LIBS += -pthread
+
+*-clang*|*-g++* {
+    CONFIG -= warn_on
+    QMAKE_CXXFLAGS += -Wall -Wextra -pedantic -Winit-self
+    QMAKE_CXXFLAGS += -Wno-strict-aliasing
+}